@@ -9,6 +9,47 @@
 #include <cctype>
 #include <memory>
 #include <utility>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <set>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <deque>
+#include <optional>
+#include <exception>
+#include <filesystem>
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <csignal>
+#endif
 
 using namespace std;
 //sadasdwdawdhinatakageyama
@@ -19,48 +60,198 @@ const string RED = "\033[31m";
 const string YELLOW = "\033[33m";
 const string CYAN = "\033[36m";
 
+// Hall used by showtimes that have no layout assigned
+const string DEFAULT_HALL = "Standard";
+
+// First line of seats.txt in the run-length record format
+const string SEAT_FORMAT_HEADER = "#SEATS,2";
+
+// Past showtimes moved to the archive per maintenance pass, how often
+// maintenance looks for them, and the marker of a batch whose move has not
+// finished yet
+const size_t ARCHIVE_BATCH_SIZE = 8;
+const chrono::seconds ARCHIVE_CHECK_INTERVAL(60);
+const string ARCHIVE_PENDING_FILE = "archive.pending";
+
+// Deleted movies and showtimes waiting for the vacuum, and how many
+// showtimes one maintenance pass removes for good
+const string RETIRED_FILE = "retired.txt";
+const size_t VACUUM_BATCH_SIZE = 16;
+
+// Shared by every instance running against the same data directory
+const string LOCK_FILE = "cinema.lock";
+const string JOURNAL_FILE = "journal.txt";
+
+// The journal is restarted under a new generation once it grows past this
+const streamoff JOURNAL_COMPACT_BYTES = 1 << 20;
+
+// High-water mark of booking IDs handed out by any instance, and how many
+// each instance reserves from it (and each thread from the instance) at once
+const string BOOKING_ID_FILE = "booking_ids.txt";
+const int PROCESS_ID_BLOCK = 64;
+const int THREAD_ID_BLOCK = 8;
+
+// Booking server endpoint (--server / --client / --loadgen)
+const string DEFAULT_SOCKET = "cinema.sock";
+
 // Forward declarations
 class CinemaBookingSystem;
 
-// Helper function to clear input buffer
-void clearInputBuffer() {
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-}
-
-// Helper function for numeric input validation
-int getValidChoice(int min, int max) {
-    int choice;
-    bool valid = false;
-    while (!valid) {
-        cout << CYAN << "\n  Enter your choice (" << min << "-" << max << "): " << RESET;
-        if (cin >> choice && choice >= min && choice <= max) {
-            clearInputBuffer();
-            valid = true;
-        } else {
-            cin.clear();
-            clearInputBuffer();
-            cout << RED << "\n  Invalid input. Please try again." << RESET << endl;
+// Records scoped spans in Chrome trace-event format (open the output in
+// chrome://tracing or ui.perfetto.dev). Enabled by setting CINEMA_TRACE to the
+// output file path. Each thread writes into its own ring buffer without
+// locking. A flush pauses each ring while it reads it, and a ring's events
+// move into the recorder when its thread exits.
+class TraceRecorder {
+public:
+    struct Event {
+        const char* name;
+        const char* category;
+        long long startUs;
+        long long durationUs;
+    };
+
+private:
+    static const size_t RING_SIZE = 4096;
+    // Events kept from threads that have exited, oldest dropped first
+    static const size_t FINISHED_LIMIT = RING_SIZE * 8;
+
+    struct ThreadRing {
+        Event events[RING_SIZE];
+        atomic<size_t> head{0};
+        atomic<bool> writing{false}; // the owner is filling a slot
+        atomic<bool> paused{false};  // a flush is reading; the owner drops spans
+        int threadID = 0;
+    };
+
+    // Hands the ring back when its thread exits
+    struct RingOwner {
+        ThreadRing* ring = nullptr;
+        ~RingOwner() {
+            if (ring) TraceRecorder::get().release(ring);
+        }
+    };
+
+    bool enabled;
+    string outputPath;
+    chrono::steady_clock::time_point origin;
+    mutex registryMutex; // only taken when a thread starts or stops recording, and on flush
+    vector<unique_ptr<ThreadRing>> rings;
+    deque<pair<int, Event>> finished; // thread ID, event
+    int nextThreadID = 1;
+
+    TraceRecorder() : enabled(false), origin(chrono::steady_clock::now()) {
+        const char* path = getenv("CINEMA_TRACE");
+        if (path && *path) {
+            enabled = true;
+            outputPath = path;
         }
     }
-    return choice;
-}
 
-// Helper function for yes/no confirmations
-bool getConfirmation(const string& prompt) {
-    char confirm;
-    bool valid = false;
-    while (!valid) {
-        cout << YELLOW << "\n  " << prompt << " (Y/N): " << RESET;
-        cin >> confirm;
-        clearInputBuffer();
-        confirm = toupper(confirm);
-        if (confirm == 'Y') return true;
-        if (confirm == 'N') return false;
-        cout << RED << "\n  Invalid input. Please enter Y or N." << RESET << endl;
+    ThreadRing& localRing() {
+        thread_local RingOwner owner;
+        if (!owner.ring) {
+            lock_guard<mutex> lock(registryMutex);
+            rings.push_back(make_unique<ThreadRing>());
+            owner.ring = rings.back().get();
+            owner.ring->threadID = nextThreadID++;
+        }
+        return *owner.ring;
+    }
+
+    // Oldest to newest; called with the ring paused or its thread gone
+    template <typename Visit>
+    static void forEachEvent(const ThreadRing& ring, Visit visit) {
+        size_t head = ring.head.load(memory_order_acquire);
+        size_t begin = head > RING_SIZE ? head - RING_SIZE : 0;
+        for (size_t i = begin; i < head; i++) visit(ring.events[i % RING_SIZE]);
+    }
+
+    void release(ThreadRing* ring) {
+        lock_guard<mutex> lock(registryMutex);
+        forEachEvent(*ring, [&](const Event& e) { finished.push_back({ring->threadID, e}); });
+        while (finished.size() > FINISHED_LIMIT) finished.pop_front();
+        rings.erase(remove_if(rings.begin(), rings.end(),
+                              [ring](const unique_ptr<ThreadRing>& owned) { return owned.get() == ring; }),
+                    rings.end());
+    }
+
+public:
+    static TraceRecorder& get() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    long long nowUs() const {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - origin).count();
     }
-    return false;
-}
+
+    // Single writer per ring: the slot is filled before head is published.
+    // writing and paused are sequentially consistent, so either the flush
+    // sees the write in progress and waits for it, or the writer sees the
+    // pause and drops the span. Old events are overwritten when full.
+    void record(const char* name, const char* category, long long startUs, long long durationUs) {
+        ThreadRing& ring = localRing();
+        ring.writing.store(true);
+        if (!ring.paused.load()) {
+            size_t slot = ring.head.load(memory_order_relaxed);
+            ring.events[slot % RING_SIZE] = {name, category, startUs, durationUs};
+            ring.head.store(slot + 1, memory_order_release);
+        }
+        ring.writing.store(false);
+    }
+
+    void flush() {
+        if (!enabled) return;
+        lock_guard<mutex> lock(registryMutex);
+        ofstream traceFile(outputPath);
+        if (!traceFile.is_open()) {
+            cerr << "Unable to write trace file: " << outputPath << endl;
+            return;
+        }
+        traceFile << "{\"traceEvents\":[";
+        bool first = true;
+        auto write = [&](int threadID, const Event& e) {
+            traceFile << (first ? "" : ",") << "\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                      << "\",\"ph\":\"X\",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs
+                      << ",\"pid\":1,\"tid\":" << threadID << "}";
+            first = false;
+        };
+        for (const auto& entry : finished) write(entry.first, entry.second);
+        for (const auto& ring : rings) {
+            ring->paused.store(true);
+            while (ring->writing.load()) this_thread::yield();
+            forEachEvent(*ring, [&](const Event& e) { write(ring->threadID, e); });
+            ring->paused.store(false);
+        }
+        traceFile << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+    }
+};
+
+// RAII span: records the time between construction and destruction.
+// Names must be string literals since only the pointer is stored.
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    long long startUs;
+
+public:
+    TraceSpan(const char* n, const char* c) : name(n), category(c),
+        startUs(TraceRecorder::get().isEnabled() ? TraceRecorder::get().nowUs() : -1) {}
+
+    ~TraceSpan() {
+        if (startUs >= 0) {
+            TraceRecorder& recorder = TraceRecorder::get();
+            recorder.record(name, category, startUs, recorder.nowUs() - startUs);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
 
 // Helper function to validate date format (YYYY-MM-DD)
 bool isValidDate(const string& date) {
@@ -95,20 +286,42 @@ bool isValidTime(const string& time) {
     return hour >= 0 && hour < 24 && minute >= 0 && minute < 60;
 }
 
-// Add this helper function after the other helper functions
-string getValidPaymentMode() {
-    cout << "\nSelect Payment Mode:" << endl;
-    cout << "1. Cash" << endl;
-    cout << "2. Credit/Debit Card" << endl;
-    cout << "3. GCash" << endl;
-    
-    int choice = getValidChoice(1, 3);
-    switch (choice) {
-        case 1: return "Cash";
-        case 2: return "Credit/Debit Card";
-        case 3: return "GCash";
-        default: return "Cash";
-    }
+// Helper function to validate a showtime key (YYYY-MM-DD HH:MM)
+bool isValidShowtime(const string& showtime) {
+    return showtime.length() == 16 && showtime[10] == ' ' &&
+           isValidDate(showtime.substr(0, 10)) && isValidTime(showtime.substr(11));
+}
+
+// Helper function returning today's local date as YYYY-MM-DD
+string currentDate() {
+    time_t now = time(nullptr);
+    tm local = *localtime(&now);
+    char buffer[11];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d", &local);
+    return buffer;
+}
+
+// Local noon of a YYYY-MM-DD date moved by dayOffset days, with the weekday
+// filled in; noon keeps clear of daylight saving switches
+tm noonOf(const string& date, int dayOffset = 0) {
+    tm day = {};
+    day.tm_year = stoi(date.substr(0, 4)) - 1900;
+    day.tm_mon = stoi(date.substr(5, 2)) - 1;
+    day.tm_mday = stoi(date.substr(8, 2)) + dayOffset;
+    day.tm_hour = 12;
+    mktime(&day);
+    return day;
+}
+
+string formatDate(const tm& day) {
+    char buffer[11];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d", &day);
+    return buffer;
+}
+
+// Monday of the week a YYYY-MM-DD date falls in, as YYYY-MM-DD
+string weekStartOf(const string& date) {
+    return formatDate(noonOf(date, -((noonOf(date).tm_wday + 6) % 7)));
 }
 
 // Class definitions
@@ -124,8 +337,8 @@ public:
     string getTime() const { return time; }
     string getFullSchedule() const { return date + " " + time; }
 
-    void display() const {
-        cout << date << " at " << time;
+    void display(ostream& out = cout) const {
+        out << date << " at " << time;
     }
 };
 
@@ -144,7 +357,6 @@ public:
     string getPassword() const { return password; }
     int getUserID() const { return userID; }
 
-    virtual void displayMenu() = 0;
     virtual string getUserType() const = 0;
 };
 int User::nextUserID = 1;
@@ -158,27 +370,12 @@ public:
 
     string getName() const { return name; }
     string getUserType() const override { return "CUSTOMER"; }
-
-    void displayMenu() override;
-    void bookTicket();
-    void viewBookings();
-    void editBooking();
-    void cancelBooking();
 };
 
 class Admin : public User {
 public:
     Admin(string uname, string pwd) : User(uname, pwd) {}
     string getUserType() const override { return "ADMIN"; }
-
-    void displayMenu() override;
-    void addMovie();
-    void editMovie();
-    void deleteMovie();
-    void viewAllBookings();
-    void manageSeats();
-    void manageSchedules();
-    void generateReports();
 };
 
 class Movie {
@@ -191,7 +388,11 @@ private:
     static int nextMovieID;
 
 public:
-    Movie(string t, string g, double p) : title(t), genre(g), price(p), movieID(nextMovieID++) {}
+    Movie(string t, string g, double p) : movieID(nextMovieID++), title(t), genre(g), price(p) {}
+    // Used by the loader so IDs stay stable across saves and instances
+    Movie(int id, string t, string g, double p) : movieID(id), title(t), genre(g), price(p) {
+        nextMovieID = max(nextMovieID, id + 1);
+    }
 
     int getMovieID() const { return movieID; }
     string getTitle() const { return title; }
@@ -199,31 +400,34 @@ public:
     double getPrice() const { return price; }
     const vector<Schedule>& getSchedules() const { return schedules; }
 
+    void setTitle(const string& t) { title = t; }
+    void setGenre(const string& g) { genre = g; }
     void setPrice(double p) { price = p; }
 
     void addSchedule(const Schedule& schedule) { schedules.push_back(schedule); }
+    void reserveSchedules(size_t extra) { schedules.reserve(schedules.size() + extra); }
     void removeSchedule(int index) {
         if (index >= 0 && index < schedules.size()) {
             schedules.erase(schedules.begin() + index);
         }
     }
 
-    void displayDetails() const {
-        cout << "\n\t╔═══════════════════════════════════╗" << endl;
-        cout << CYAN << "\t║          Movie Details            ║" << RESET << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << "\t║  Movie ID: " << YELLOW << setw(23) << left << movieID << RESET << "║" << endl;
-        cout << "\t║  Title: " << YELLOW << setw(26) << left << title << RESET << "║" << endl;
-        cout << "\t║  Genre: " << YELLOW << setw(26) << left << genre << RESET << "║" << endl;
-        cout << "\t║  Price: ₱" << GREEN << setw(25) << left << fixed << setprecision(2) << price << RESET << "║" << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << CYAN << "\t║          Schedules                ║" << RESET << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
+    void displayDetails(ostream& out = cout) const {
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << CYAN << "\t║          Movie Details            ║" << RESET << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
+        out << "\t║  Movie ID: " << YELLOW << setw(23) << left << movieID << RESET << "║" << endl;
+        out << "\t║  Title: " << YELLOW << setw(26) << left << title << RESET << "║" << endl;
+        out << "\t║  Genre: " << YELLOW << setw(26) << left << genre << RESET << "║" << endl;
+        out << "\t║  Price: ₱" << GREEN << setw(25) << left << fixed << setprecision(2) << price << RESET << "║" << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
+        out << CYAN << "\t║          Schedules                ║" << RESET << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
         for (size_t i = 0; i < schedules.size(); i++) {
             string schedStr = schedules[i].getDate() + " at " + schedules[i].getTime();
-            cout << "\t║  " << YELLOW << setw(2) << left << i+1 << ". " << setw(29) << left << schedStr << RESET << "║" << endl;
+            out << "\t║  " << YELLOW << setw(2) << left << i+1 << ". " << setw(29) << left << schedStr << RESET << "║" << endl;
         }
-        cout << "\t╚═══════════════════════════════════╝" << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
     }
 };
 int Movie::nextMovieID = 1;
@@ -237,12 +441,23 @@ private:
     string seat;
     double price;
     string paymentMode;
-    static int nextBookingID;
 
 public:
+    // A booking that already has an ID (loaded, replicated or edited)
+    Booking(int id, string username, int mID, const Schedule& sched, string st, double p, string pm) :
+        bookingID(id), customerUsername(username), movieID(mID), schedule(sched), seat(st), price(p),
+        paymentMode(pm) {}
+
+    // A new booking. It has no ID (0) until CinemaBookingSystem::addBookings
+    // commits it and draws one from BookingIDAllocator, so bookings that are
+    // only built to validate or display use up no IDs.
     Booking(string username, int mID, const Schedule& sched, string st, double p, string pm) :
-        customerUsername(username), movieID(mID), schedule(sched), seat(st), price(p), 
-        paymentMode(pm), bookingID(nextBookingID++) {}
+        Booking(0, username, mID, sched, st, p, pm) {}
+
+    // The same booking under another ID
+    Booking withID(int id) const {
+        return Booking(id, customerUsername, movieID, schedule, seat, price, paymentMode);
+    }
 
     int getBookingID() const { return bookingID; }
     string getCustomerUsername() const { return customerUsername; }
@@ -252,7 +467,7 @@ public:
     double getPrice() const { return price; }
     string getPaymentMode() const { return paymentMode; }
 
-    void displayDetails(const vector<Movie>& movies) const {
+    void displayDetails(const vector<Movie>& movies, ostream& out = cout) const {
         string movieTitle = "Unknown";
         for (const auto& movie : movies) {
             if (movie.getMovieID() == movieID) {
@@ -261,1323 +476,7761 @@ public:
             }
         }
         
-        cout << "\n\t╔═══════════════════════════════════╗" << endl;
-        cout << CYAN << "\t║         Booking Details           ║" << RESET << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << "\t║  Booking ID: " << YELLOW << setw(21) << left << bookingID << RESET << "║" << endl;
-        cout << "\t║  Customer: " << YELLOW << setw(23) << left << customerUsername << RESET << "║" << endl;
-        cout << "\t║  Movie: " << YELLOW << setw(26) << left << movieTitle << RESET << "║" << endl;
-        cout << "\t║  Date: " << YELLOW << setw(27) << left << schedule.getDate() << RESET << "║" << endl;
-        cout << "\t║  Time: " << YELLOW << setw(27) << left << schedule.getTime() << RESET << "║" << endl;
-        cout << "\t║  Seat: " << YELLOW << setw(27) << left << seat << RESET << "║" << endl;
-        cout << "\t║  Price: ₱" << GREEN << setw(25) << left << fixed << setprecision(2) << price << RESET << "║" << endl;
-        cout << "\t║  Payment Mode: " << YELLOW << setw(19) << left << paymentMode << RESET << "║" << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << CYAN << "\t║         Booking Details           ║" << RESET << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
+        out << "\t║  Booking ID: " << YELLOW << setw(21) << left << bookingID << RESET << "║" << endl;
+        out << "\t║  Customer: " << YELLOW << setw(23) << left << customerUsername << RESET << "║" << endl;
+        out << "\t║  Movie: " << YELLOW << setw(26) << left << movieTitle << RESET << "║" << endl;
+        out << "\t║  Date: " << YELLOW << setw(27) << left << schedule.getDate() << RESET << "║" << endl;
+        out << "\t║  Time: " << YELLOW << setw(27) << left << schedule.getTime() << RESET << "║" << endl;
+        out << "\t║  Seat: " << YELLOW << setw(27) << left << seat << RESET << "║" << endl;
+        out << "\t║  Price: ₱" << GREEN << setw(25) << left << fixed << setprecision(2) << price << RESET << "║" << endl;
+        out << "\t║  Payment Mode: " << YELLOW << setw(19) << left << paymentMode << RESET << "║" << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
     }
 };
-int Booking::nextBookingID = 1;
 
-class CinemaBookingSystem {
+// Helper function to count set bits in a 64-bit word
+inline int popcount64(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word) {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Physical layout of a cinema hall: rows 'A'.. and seats numbered 1.. per row.
+// Blocked positions (aisles, gaps) are part of the grid but never hold a seat.
+class HallLayout {
 private:
-    static CinemaBookingSystem* instance;
-    vector<unique_ptr<User>> users;
-    vector<Movie> movies;
-    vector<Booking> bookings;
-    map<pair<int, string>, map<string, bool>> movieSeats; // <movieID, date> -> seats
+    string name;
+    int rows;
+    int seatsPerRow;
+    vector<uint64_t> blockedBits;
 
-    CinemaBookingSystem() { loadData(); }
+public:
+    static const int MAX_ROWS = 26;
+    static const int MAX_SEATS_PER_ROW = 60;
 
-    void initializeSeatsForMovie(int movieID, const string& date) {
-        map<string, bool> seats;
-        for (char row = 'A'; row <= 'H'; row++) {
-            for (int num = 1; num <= 10; num++) {
-                seats[string(1, row) + to_string(num)] = true;
-            }
-        }
-        movieSeats[{movieID, date}] = seats;
-    }
+    HallLayout(string n, int r, int s) : name(n), rows(r), seatsPerRow(s),
+        blockedBits((r * s + 63) / 64, 0) {}
 
-    void loadData() {
-        // Load users
-        ifstream userFile("users.txt");
-        if (userFile.is_open()) {
-            string line;
-            while (getline(userFile, line)) {
-                vector<string> tokens;
-                string token;
-                istringstream tokenStream(line);
-                while (getline(tokenStream, token, ',')) {
-                    tokens.push_back(token);
-                }
+    string getName() const { return name; }
+    int getRows() const { return rows; }
+    int getSeatsPerRow() const { return seatsPerRow; }
+    int positions() const { return rows * seatsPerRow; }
+    size_t wordCount() const { return blockedBits.size(); }
+    const vector<uint64_t>& getBlockedBits() const { return blockedBits; }
 
-                try {
-                    if (tokens.size() >= 3) {
-                        if (tokens[0] == "CUSTOMER" && tokens.size() >= 4) {
-                            users.push_back(make_unique<Customer>(tokens[1], tokens[2], tokens[3]));
-                        } else if (tokens[0] == "ADMIN") {
-                            users.push_back(make_unique<Admin>(tokens[1], tokens[2]));
-                        }
-                    }
-                } catch (...) {
-                    cerr << "Error loading user: " << line << endl;
-                }
-            }
-            userFile.close();
+    int capacity() const {
+        int blocked = 0;
+        for (uint64_t word : blockedBits) blocked += popcount64(word);
+        return positions() - blocked;
+    }
+
+    // Returns the grid index for a label like "C7", or -1 if it is outside the grid
+    int seatIndex(const string& label) const {
+        if (label.size() < 2 || label.size() > 3) return -1;
+        int row = toupper(static_cast<unsigned char>(label[0])) - 'A';
+        if (row < 0 || row >= rows) return -1;
+        int number = 0;
+        for (size_t i = 1; i < label.size(); i++) {
+            if (!isdigit(static_cast<unsigned char>(label[i]))) return -1;
+            number = number * 10 + (label[i] - '0');
         }
+        if (number < 1 || number > seatsPerRow) return -1;
+        return row * seatsPerRow + (number - 1);
+    }
 
-        // Load movies
-        ifstream movieFile("movies.txt");
-        if (movieFile.is_open()) {
-            string line;
-            while (getline(movieFile, line)) {
-                vector<string> tokens;
-                string token;
-                istringstream tokenStream(line);
-                while (getline(tokenStream, token, ',')) {
-                    tokens.push_back(token);
-                }
+    string seatLabel(int index) const {
+        return string(1, static_cast<char>('A' + index / seatsPerRow)) + to_string(index % seatsPerRow + 1);
+    }
 
-                if (tokens.size() >= 4) {
-                    try {
-                        double price = stod(tokens[3]);
-                        Movie movie(tokens[1], tokens[2], price);
-                        for (size_t i = 4; i < tokens.size(); i += 2) {
-                            if (i + 1 < tokens.size()) {
-                                movie.addSchedule(Schedule(tokens[i], tokens[i+1]));
-                            }
-                        }
-                        movies.push_back(movie);
-                    } catch (...) {
-                        cerr << "Error loading movie: " << line << endl;
-                    }
-                }
-            }
-            movieFile.close();
+    bool isBlocked(int index) const { return (blockedBits[index / 64] >> (index % 64)) & 1; }
+    void setBlocked(int index, bool blocked) {
+        if (blocked) blockedBits[index / 64] |= 1ULL << (index % 64);
+        else blockedBits[index / 64] &= ~(1ULL << (index % 64));
+    }
+
+    // Blocked positions as "A1;A2;..." for halls.txt
+    string blockedList() const {
+        string list;
+        for (int i = 0; i < positions(); i++) {
+            if (isBlocked(i)) list += (list.empty() ? "" : ";") + seatLabel(i);
         }
+        return list;
+    }
+};
 
-        // Load bookings
-        ifstream bookingFile("bookings.txt");
-        if (bookingFile.is_open()) {
-            string line;
-            while (getline(bookingFile, line)) {
-                vector<string> tokens;
-                string token;
-                istringstream tokenStream(line);
-                while (getline(tokenStream, token, ',')) {
-                    tokens.push_back(token);
-                }
+// Bit-level operations over a seat map's words. Common hall sizes get a kernel
+// whose word count is a compile-time constant so the loops fully unroll; any
+// other geometry uses the runtime-sized fallback.
+struct SeatKernel {
+    int (*countBits)(const uint64_t* words, size_t wordCount);
+    int (*countAvailable)(const uint64_t* open, const uint64_t* booked, size_t wordCount);
+};
 
-                if (tokens.size() >= 7) {
-                    try {
-                        bookings.push_back(Booking(
-                            tokens[1], 
-                            stoi(tokens[2]), 
-                            Schedule(tokens[3], tokens[4]), 
-                            tokens[5],
-                            stod(tokens[6]),
-                            tokens[7]
-                        ));
-                    } catch (...) {
-                        cerr << "Error loading booking: " << line << endl;
-                    }
-                }
-            }
-            bookingFile.close();
-        }
+template <int Rows, int SeatsPerRow>
+struct FixedSeatKernel {
+    static constexpr int WORDS = (Rows * SeatsPerRow + 63) / 64;
 
-        // Load seats
-        ifstream seatFile("seats.txt");
-        if (seatFile.is_open()) {
-            string line;
-            while (getline(seatFile, line)) {
-                vector<string> tokens;
-                string token;
-                istringstream tokenStream(line);
-                while (getline(tokenStream, token, ',')) {
-                    tokens.push_back(token);
-                }
+    static int countBits(const uint64_t* words, size_t) {
+        int count = 0;
+        for (int i = 0; i < WORDS; i++) count += popcount64(words[i]);
+        return count;
+    }
 
-                if (tokens.size() >= 4) {
-                    try {
-                        int movieID = stoi(tokens[0]);
-                        string date = tokens[1];
-                        string seat = tokens[2];
-                        bool available = (tokens[3] == "1");
-                        movieSeats[{movieID, date}][seat] = available;
-                    } catch (...) {
-                        cerr << "Error loading seat: " << line << endl;
-                    }
-                }
-            }
-            seatFile.close();
-        } else {
-            // Initialize seats for existing movies
-            for (const auto& movie : movies) {
-                for (const auto& schedule : movie.getSchedules()) {
-                    initializeSeatsForMovie(movie.getMovieID(), schedule.getDate());
-                }
-            }
-        }
+    static int countAvailable(const uint64_t* open, const uint64_t* booked, size_t) {
+        int count = 0;
+        for (int i = 0; i < WORDS; i++) count += popcount64(open[i] & ~booked[i]);
+        return count;
     }
 
-public:
-    static CinemaBookingSystem* getInstance() {
-        if (!instance) instance = new CinemaBookingSystem();
-        return instance;
+    static const SeatKernel ops;
+};
+
+template <int Rows, int SeatsPerRow>
+const SeatKernel FixedSeatKernel<Rows, SeatsPerRow>::ops = {
+    &FixedSeatKernel<Rows, SeatsPerRow>::countBits,
+    &FixedSeatKernel<Rows, SeatsPerRow>::countAvailable
+};
+
+struct GenericSeatKernel {
+    static int countBits(const uint64_t* words, size_t wordCount) {
+        int count = 0;
+        for (size_t i = 0; i < wordCount; i++) count += popcount64(words[i]);
+        return count;
     }
 
-    static void cleanup() {
-        delete instance;
-        instance = nullptr;
+    static int countAvailable(const uint64_t* open, const uint64_t* booked, size_t wordCount) {
+        int count = 0;
+        for (size_t i = 0; i < wordCount; i++) count += popcount64(open[i] & ~booked[i]);
+        return count;
     }
 
-    ~CinemaBookingSystem() { saveData(); }
+    static const SeatKernel ops;
+};
+const SeatKernel GenericSeatKernel::ops = { &GenericSeatKernel::countBits, &GenericSeatKernel::countAvailable };
 
-    void saveData() {
-        // Save users
-        ofstream userFile("users.txt");
-        if (userFile.is_open()) {
-            for (const auto& user : users) {
-                if (user->getUserType() == "CUSTOMER") {
-                    Customer* cust = dynamic_cast<Customer*>(user.get());
-                    if (cust) {
-                        userFile << "CUSTOMER," << cust->getUsername() << "," 
-                                << cust->getPassword() << "," << cust->getName() << endl;
-                    }
-                } else if (user->getUserType() == "ADMIN") {
-                    userFile << "ADMIN," << user->getUsername() << "," << user->getPassword() << endl;
-                }
-            }
-            userFile.close();
-        }
+const SeatKernel* selectSeatKernel(int rows, int seatsPerRow) {
+    if (rows == 5 && seatsPerRow == 8) return &FixedSeatKernel<5, 8>::ops;
+    if (rows == 8 && seatsPerRow == 10) return &FixedSeatKernel<8, 10>::ops;
+    if (rows == 10 && seatsPerRow == 15) return &FixedSeatKernel<10, 15>::ops;
+    if (rows == 12 && seatsPerRow == 20) return &FixedSeatKernel<12, 20>::ops;
+    if (rows == 20 && seatsPerRow == 30) return &FixedSeatKernel<20, 30>::ops;
+    return &GenericSeatKernel::ops;
+}
 
-        // Save movies
-        ofstream movieFile("movies.txt");
-        if (movieFile.is_open()) {
-            for (const auto& movie : movies) {
-                movieFile << movie.getMovieID() << "," << movie.getTitle() << "," 
-                         << movie.getGenre() << "," << fixed << setprecision(2) << movie.getPrice();
-                for (const auto& sched : movie.getSchedules()) {
-                    movieFile << "," << sched.getDate() << "," << sched.getTime();
-                }
-                movieFile << endl;
-            }
-            movieFile.close();
-        }
+// Seat state of one showtime. A position is "open" when it holds a seat for
+// this showtime (layout positions minus blocked ones minus seats removed by an
+// admin) and "booked" when a ticket was sold for it. The number of free seats
+// is kept up to date by every change so listings never have to count.
+class SeatMap {
+private:
+    const HallLayout* layout;
+    const SeatKernel* kernel;
+    vector<uint64_t> openBits;
+    vector<uint64_t> bookedBits;
+    int freeSeats;
 
-        // Save bookings
-        ofstream bookingFile("bookings.txt");
-        if (bookingFile.is_open()) {
-            for (const auto& booking : bookings) {
-                bookingFile << booking.getBookingID() << "," << booking.getCustomerUsername() << ","
-                           << booking.getMovieID() << "," << booking.getSchedule().getDate() << ","
-                           << booking.getSchedule().getTime() << "," << booking.getSeat() << ","
-                           << fixed << setprecision(2) << booking.getPrice() << "," << booking.getPaymentMode() << endl;
-            }
-            bookingFile.close();
-        }
+    static bool testBit(const vector<uint64_t>& bits, int index) { return (bits[index / 64] >> (index % 64)) & 1; }
+    static void setBit(vector<uint64_t>& bits, int index, bool value) {
+        if (value) bits[index / 64] |= 1ULL << (index % 64);
+        else bits[index / 64] &= ~(1ULL << (index % 64));
+    }
 
-        // Save seats
-        ofstream seatFile("seats.txt");
-        if (seatFile.is_open()) {
-            for (const auto& movieSeatPair : movieSeats) {
-                int movieID = movieSeatPair.first.first;
-                string date = movieSeatPair.first.second;
-                for (const auto& seat : movieSeatPair.second) {
-                    seatFile << movieID << "," << date << "," << seat.first << "," << seat.second << endl;
-                }
+public:
+    // allOpen = false starts with no seats, for loaders that open them one by one
+    explicit SeatMap(const HallLayout& hall, bool allOpen = true) : layout(&hall),
+        kernel(selectSeatKernel(hall.getRows(), hall.getSeatsPerRow())),
+        openBits(hall.wordCount(), 0), bookedBits(hall.wordCount(), 0), freeSeats(0) {
+        if (allOpen) {
+            for (int i = 0; i < hall.positions(); i++) {
+                if (!hall.isBlocked(i)) setBit(openBits, i, true);
             }
-            seatFile.close();
+            freeSeats = recountAvailable();
         }
     }
 
-    vector<unique_ptr<User>>& getUsers() { return users; }
-    vector<Movie>& getMovies() { return movies; }
-    vector<Booking>& getBookings() { return bookings; }
+    const HallLayout& getLayout() const { return *layout; }
+    const vector<uint64_t>& getOpenBits() const { return openBits; }
+    const vector<uint64_t>& getBookedBits() const { return bookedBits; }
 
-    // Seat management interface
-    void initializeSeatsForNewMovie(int movieID, const string& date) {
-        initializeSeatsForMovie(movieID, date);
-    }
+    int indexOf(const string& seat) const { return layout->seatIndex(seat); }
+    bool hasSeat(int index) const { return index >= 0 && testBit(openBits, index); }
+    bool isBooked(int index) const { return index >= 0 && testBit(bookedBits, index); }
+    bool isAvailable(int index) const { return hasSeat(index) && !isBooked(index); }
 
-    void removeSeatsForMovie(int movieID, const string& date) {
-        movieSeats.erase({movieID, date});
+    bool book(int index) {
+        if (!isAvailable(index)) return false;
+        setBit(bookedBits, index, true);
+        freeSeats--;
+        return true;
     }
 
-    bool hasBookingsForSchedule(int movieID, const string& date) const {
-        return any_of(bookings.begin(), bookings.end(), 
-            [&](const Booking& b) { 
-                return b.getMovieID() == movieID && b.getSchedule().getDate() == date; 
-            });
+    bool release(int index) {
+        if (!hasSeat(index) || !isBooked(index)) return false;
+        setBit(bookedBits, index, false);
+        freeSeats++;
+        return true;
     }
 
-    bool isSeatAvailable(int movieID, const string& date, const string& seat) const {
-        auto it = movieSeats.find({movieID, date});
-        return it != movieSeats.end() && it->second.count(seat) && it->second.at(seat);
+    void openSeat(int index) {
+        if (hasSeat(index)) return;
+        setBit(openBits, index, true);
+        setBit(bookedBits, index, false);
+        freeSeats++;
     }
 
-    void bookSeat(int movieID, const string& date, const string& seat) {
-        auto& seats = movieSeats[{movieID, date}];
-        if (seats.count(seat)) seats[seat] = false;
+    void closeSeat(int index) {
+        if (!hasSeat(index)) return;
+        if (!isBooked(index)) freeSeats--;
+        setBit(openBits, index, false);
+        setBit(bookedBits, index, false);
     }
 
-    void freeSeat(int movieID, const string& date, const string& seat) {
-        auto& seats = movieSeats[{movieID, date}];
-        if (seats.count(seat)) seats[seat] = true;
-    }
+    int seatCount() const { return kernel->countBits(openBits.data(), openBits.size()); }
+    int bookedCount() const { return kernel->countBits(bookedBits.data(), bookedBits.size()); }
+    int availableCount() const { return freeSeats; }
+    bool isSoldOut() const { return freeSeats == 0; }
 
-    void displaySeatLayout(int movieID, const string& date) const {
-        auto it = movieSeats.find({movieID, date});
-        if (it == movieSeats.end()) {
-            cout << "\n\t╔═══════════════════════════════════╗" << endl;
-            cout << YELLOW << "\t║   No seat data for this date      ║" << RESET << endl;
-            cout << "\t╚═══════════════════════════════════╝" << endl;
-            return;
+    // Full popcount over the bitsets, used to initialise and cross-check freeSeats
+    int recountAvailable() const { return kernel->countAvailable(openBits.data(), bookedBits.data(), openBits.size()); }
+};
+
+// Finds the best free seat of a showtime, or the best block of adjacent free
+// seats in one row. Scores come from a table computed once per hall geometry:
+// seats near the middle of a row and in the row about two thirds of the way
+// back score highest. A pick that would strand a single free seat next to it
+// loses points. Each row is scanned as one word: a block of n seats can start
+// wherever n consecutive bits of the row's free mask are set.
+class SeatRecommender {
+public:
+    static const int GAP_PENALTY = 60;
+
+    struct Pick {
+        int first = -1; // grid index of the leftmost seat, -1 if nothing fits
+        int count = 0;
+        int score = 0;
+    };
+
+    static Pick best(const SeatMap& seats, int count) {
+        Pick pick;
+        const HallLayout& hall = seats.getLayout();
+        int width = hall.getSeatsPerRow();
+        if (count < 1 || count > width || width > 63) return pick;
+        const ScoreTable& table = tableFor(hall.getRows(), width);
+
+        for (int row = 0; row < hall.getRows(); row++) {
+            int start = row * width;
+            uint64_t free = rowBits(seats.getOpenBits(), start, width) & ~rowBits(seats.getBookedBits(), start, width);
+            uint64_t starts = free;
+            for (int k = 1; k < count && starts; k++) starts &= free >> k;
+            for (; starts; starts &= starts - 1) {
+                int col = popcount64((starts & (~starts + 1)) - 1);
+                int score = table.blockScore(row, col, count) - GAP_PENALTY * strandedSeats(free, col, count, width);
+                if (pick.first < 0 || score > pick.score) pick = {start + col, count, score};
+            }
         }
+        return pick;
+    }
 
-        cout << "\n\t╔═══════════════════════════════════════════════╗" << endl;
-        cout << CYAN << "\t║                    SCREEN                     ║" << RESET << endl;
-        cout << "\t╚═══════════════════════════════════════════════╝" << endl;
-        
-        // Display column numbers
-        cout << "\n\t       ";
-        for (int num = 1; num <= 10; num++) {
-            cout << YELLOW << setw(3) << num << RESET;
+private:
+    // Seat scores as running sums per row, so a block scores in O(1)
+    struct ScoreTable {
+        int width = 0;
+        vector<int> prefix; // row * (width + 1) + col -> sum of the row's scores before col
+
+        int blockScore(int row, int col, int count) const {
+            const int* rowSums = &prefix[row * (width + 1)];
+            return rowSums[col + count] - rowSums[col];
         }
-        cout << endl;
+    };
 
-        // Create horizontal line using individual characters
-        cout << "\t     ╔";
-        for (int i = 0; i < 31; i++) cout << "═";
-        cout << "╗" << endl;
-        
-        // Display seat rows
-        for (char row = 'A'; row <= 'H'; row++) {
-            cout << "\t  " << YELLOW << row << RESET << "  ║";
-            for (int num = 1; num <= 10; num++) {
-                string seat = string(1, row) + to_string(num);
-                if (it->second.at(seat)) {
-                    cout << " " << GREEN << "O" << RESET << " ";
-                } else {
-                    cout << " " << RED << "X" << RESET << " ";
-                }
+    static const ScoreTable& tableFor(int rows, int width) {
+        static mutex tablesMutex;
+        static map<pair<int, int>, ScoreTable> tables;
+        lock_guard<mutex> lock(tablesMutex);
+        auto found = tables.find({rows, width});
+        if (found != tables.end()) return found->second;
+
+        ScoreTable table;
+        table.width = width;
+        int bestRow = (rows - 1) * 2 / 3;
+        int rowSpan = max(1, max(bestRow, rows - 1 - bestRow));
+        for (int row = 0; row < rows; row++) {
+            int sum = 0;
+            table.prefix.push_back(0);
+            for (int col = 0; col < width; col++) {
+                int offCenter = abs(2 * col - (width - 1)) * 100 / max(1, width - 1);
+                int offRow = abs(row - bestRow) * 100 / rowSpan;
+                sum += 200 - offCenter - offRow;
+                table.prefix.push_back(sum);
             }
-            cout << " ║" << endl;
         }
-        
-        // Create bottom horizontal line using individual characters
-        cout << "\t     ╚";
-        for (int i = 0; i < 31; i++) cout << "═";
-        cout << "╝" << endl;
+        return tables.emplace(make_pair(rows, width), std::move(table)).first->second;
+    }
 
-        // Display key and additional information
-        cout << "\n\t╔═══════════════════════════════════╗" << endl;
-        cout << "\t║    " << GREEN << "O" << RESET << " = Available    " << RED << "X" << RESET << " = Booked    ║" << endl;
-        cout << "\t║    [ ] = Your Selection           ║" << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
+    // Bits [start, start + width) of a seat bitset as one word (width < 64)
+    static uint64_t rowBits(const vector<uint64_t>& bits, int start, int width) {
+        uint64_t word = bits[start / 64] >> (start % 64);
+        int taken = 64 - start % 64;
+        if (taken < width) word |= bits[start / 64 + 1] << taken;
+        return word & ((1ULL << width) - 1);
     }
 
-    User* login() {
-        string username, password;
-        bool loggedIn = false;
-        User* user = nullptr;
-        
-        while (!loggedIn) {
-            cout << "\n\t╔═══════════════════════════════════╗" << endl;
-            cout << "\t║             Login                 ║" << endl;
-            cout << "\t╚═══════════════════════════════════╝\n" << endl;
-            
-            cout << "  Username (or '0' to cancel): ";
-            getline(cin, username);
-            
-            // Check for spaces in username
-            if (username.find(' ') != string::npos) {
-                cout << RED << "\n  Error: Username cannot contain spaces. Please try again." << RESET << endl;
-                continue;
-            }
-            
-            if (username == "0") {
-                break;
-            }
-            
-            bool validPassword = false;
-            while (!validPassword && !loggedIn) {
-                cout << "  Password: ";
-                getline(cin, password);
-                
-                // Check for spaces in password
-                if (password.find(' ') != string::npos) {
-                    cout << RED << "\n  Error: Password cannot contain spaces. Please try again." << RESET << endl;
-                    continue;
-                }
+    // Free seats the block [col, col + count) would leave with no free neighbour
+    static int strandedSeats(uint64_t free, int col, int count, int width) {
+        auto isFree = [&](int c) { return c >= 0 && c < width && ((free >> c) & 1); };
+        int right = col + count;
+        return (isFree(col - 1) && !isFree(col - 2)) + (isFree(right) && !isFree(right + 1));
+    }
+};
 
-                for (const auto& u : users) {
-                    if (u->getUsername() == username && u->getPassword() == password) {
-                        cout << GREEN << "\n  Login successful!" << RESET << endl;
-                        user = u.get();
-                        loggedIn = true;
-                        break;
-                    }
-                }
-                
-                if (!loggedIn) {
-                    cout << RED << "\n  Invalid username or password. Please try again." << RESET << endl;
-                    break;
-                } else {
-                    validPassword = true;
-                }
+// Per-position counters stored bit-sliced: plane k holds bit k of every
+// position's count. Adding a whole seat bitset is a ripple-carry over the
+// planes, 64 positions per word operation, instead of one increment per seat.
+class BitSlicedCounter {
+private:
+    size_t wordCount;
+    vector<vector<uint64_t>> planes;
+
+public:
+    explicit BitSlicedCounter(size_t words) : wordCount(words) {}
+
+    void add(const vector<uint64_t>& bits) {
+        for (size_t i = 0; i < wordCount; i++) {
+            uint64_t carry = bits[i];
+            for (size_t k = 0; carry != 0; k++) {
+                if (k == planes.size()) planes.emplace_back(wordCount, 0);
+                uint64_t overflow = planes[k][i] & carry;
+                planes[k][i] ^= carry;
+                carry = overflow;
             }
         }
-        return user;
     }
 
-    void registerUser() {
-        string username, password, name;
-        bool registered = false;
-        
-        while (!registered) {
-            cout << "\n\t╔═══════════════════════════════════╗" << endl;
-            cout << "\t║        User Registration          ║" << endl;
-            cout << "\t╚═══════════════════════════════════╝\n" << endl;
-            
-            // Get username with space validation
-            bool validUsername = false;
-            while (!validUsername && !registered) {
-                cout << "  Username (no spaces allowed): ";
-                getline(cin, username);
-                if (username.find(' ') != string::npos) {
-                    cout << RED << "\n  Error: Username cannot contain spaces. Please try again." << RESET << endl;
-                } else if (username.empty()) {
-                    cout << RED << "\n  Error: Username cannot be empty. Please try again." << RESET << endl;
-                } else {
-                    validUsername = true;
-                }
-            }
-            
-            if (!validUsername) continue;
+    int countAt(int index) const {
+        int count = 0;
+        for (size_t k = 0; k < planes.size(); k++) {
+            count |= static_cast<int>((planes[k][index / 64] >> (index % 64)) & 1) << k;
+        }
+        return count;
+    }
+};
 
-            bool usernameTaken = false;
-            for (const auto& user : users) {
-                if (user->getUsername() == username) {
-                    usernameTaken = true;
-                    break;
+// Scores kept in ranked order as they change: setting a key's score is
+// O(log n) and the best K keys are read off the front in O(K). A score of
+// zero or less removes the key.
+template <typename Key>
+class Leaderboard {
+private:
+    map<Key, double> scores;
+    set<pair<double, Key>, greater<pair<double, Key>>> ranked; // best first
+
+public:
+    void update(const Key& key, double score) {
+        remove(key);
+        if (score <= 0) return;
+        scores[key] = score;
+        ranked.insert({score, key});
+    }
+
+    void remove(const Key& key) {
+        auto it = scores.find(key);
+        if (it == scores.end()) return;
+        ranked.erase({it->second, key});
+        scores.erase(it);
+    }
+
+    bool empty() const { return scores.empty(); }
+
+    // The best k entries that pass keep(key), best first
+    template <typename Keep>
+    vector<pair<Key, double>> top(size_t k, Keep keep) const {
+        vector<pair<Key, double>> best;
+        for (auto it = ranked.begin(); it != ranked.end() && best.size() < k; ++it) {
+            if (keep(it->second)) best.push_back({it->second, it->first});
+        }
+        return best;
+    }
+};
+
+// Title-prefix and genre lookup over one version of the catalog. Every word
+// of a title is a key, so "mine" finds "A Minecraft Movie", and genres are
+// split on '/', so "Horror/Mystery" is listed under both. Keys are lowercase
+// and sorted; a lookup is a binary search plus the matches. Results come in
+// title order.
+class CatalogIndex {
+private:
+    struct Entry {
+        int movieID;
+        string title;
+        string genre;
+        bool operator==(const Entry& other) const {
+            return movieID == other.movieID && title == other.title && genre == other.genre;
+        }
+    };
+
+    vector<Entry> entries;                  // catalog order, to tell whether the index is current
+    vector<int> byTitle;                    // every movie, title order
+    unordered_map<int, size_t> titleRank;   // movie -> position in byTitle
+    vector<pair<string, int>> titleKeys;    // title from each word start -> movie
+    map<string, vector<int>> byGenre;       // genre -> movies, title order
+
+    static string lowercase(string text) {
+        transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return tolower(c); });
+        return text;
+    }
+
+public:
+    explicit CatalogIndex(const vector<Movie>& movies) {
+        for (const auto& movie : movies) entries.push_back({movie.getMovieID(), movie.getTitle(), movie.getGenre()});
+        vector<const Entry*> sorted;
+        for (const auto& entry : entries) sorted.push_back(&entry);
+        stable_sort(sorted.begin(), sorted.end(),
+                    [](const Entry* a, const Entry* b) { return lowercase(a->title) < lowercase(b->title); });
+        for (const Entry* entry : sorted) {
+            titleRank[entry->movieID] = byTitle.size();
+            byTitle.push_back(entry->movieID);
+
+            string title = lowercase(entry->title);
+            for (size_t i = 0; i < title.size(); i++) {
+                if (!isspace(static_cast<unsigned char>(title[i])) && (i == 0 || isspace(static_cast<unsigned char>(title[i - 1])))) {
+                    titleKeys.push_back({title.substr(i), entry->movieID});
                 }
             }
-            
-            if (usernameTaken) {
-                cout << RED << "\n  Error: Username already exists. Please choose another." << RESET << endl;
-                continue;
+            istringstream genres(lowercase(entry->genre));
+            string genre;
+            while (getline(genres, genre, '/')) {
+                if (!genre.empty()) byGenre[genre].push_back(entry->movieID);
             }
+        }
+        sort(titleKeys.begin(), titleKeys.end());
+    }
 
-            // Get password with space validation
-            bool validPassword = false;
-            while (!validPassword && !registered) {
-                cout << "  Password (no spaces allowed): ";
-                getline(cin, password);
-                if (password.find(' ') != string::npos) {
-                    cout << RED << "\n  Error: Password cannot contain spaces. Please try again." << RESET << endl;
-                } else if (password.empty()) {
-                    cout << RED << "\n  Error: Password cannot be empty. Please try again." << RESET << endl;
-                } else {
-                    validPassword = true;
-                }
-            }
-            
-            if (!validPassword) continue;
+    // True if the index was built from a catalog with the same movies, titles and genres
+    bool covers(const vector<Movie>& movies) const {
+        if (movies.size() != entries.size()) return false;
+        for (size_t i = 0; i < movies.size(); i++) {
+            if (!(entries[i] == Entry{movies[i].getMovieID(), movies[i].getTitle(), movies[i].getGenre()})) return false;
+        }
+        return true;
+    }
 
-            cout << "  Full Name: ";
-            getline(cin, name);
+    // Movies with a title word starting with titlePrefix and, if genre is
+    // not empty, listed under that genre; both ignore case
+    vector<int> search(const string& titlePrefix, const string& genre) const {
+        const vector<int>* genreMatches = nullptr;
+        if (!genre.empty()) {
+            auto found = byGenre.find(lowercase(genre));
+            if (found == byGenre.end()) return {};
+            genreMatches = &found->second;
+        }
+        if (titlePrefix.empty()) return genreMatches ? *genreMatches : byTitle;
 
-            if (getConfirmation("Confirm registration?")) {
-                users.push_back(make_unique<Customer>(username, password, name));
-                saveData();
-                cout << GREEN << "\n  Registration successful! You can now login." << RESET << endl;
-                registered = true;
-            } else {
-                cout << YELLOW << "\n  Registration cancelled." << RESET << endl;
-                registered = true;
+        string prefix = lowercase(titlePrefix);
+        set<int> genreSet;
+        if (genreMatches) genreSet.insert(genreMatches->begin(), genreMatches->end());
+        vector<size_t> ranks;
+        set<int> seen;
+        for (auto it = lower_bound(titleKeys.begin(), titleKeys.end(), prefix,
+                                   [](const pair<string, int>& key, const string& value) { return key.first < value; });
+             it != titleKeys.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            if ((!genreMatches || genreSet.count(it->second)) && seen.insert(it->second).second) {
+                ranks.push_back(titleRank.at(it->second));
             }
         }
+        sort(ranks.begin(), ranks.end());
+        vector<int> matches;
+        for (size_t rank : ranks) matches.push_back(byTitle[rank]);
+        return matches;
     }
 
-    void addBooking(const Booking& booking) {
-        bookings.push_back(booking);
-        bookSeat(booking.getMovieID(), booking.getSchedule().getDate(), booking.getSeat());
-        saveData();
+    // Genre names in the index, for prompts
+    vector<string> genres() const {
+        vector<string> names;
+        for (const auto& genre : byGenre) names.push_back(genre.first);
+        return names;
     }
+};
 
-    void removeBooking(int index) {
-        if (index >= 0 && index < bookings.size()) {
-            Booking& booking = bookings[index];
-            freeSeat(booking.getMovieID(), booking.getSchedule().getDate(), booking.getSeat());
-            bookings.erase(bookings.begin() + index);
-            saveData();
-        }
-    }
+// Writer for the columnar export format (.ccol). All integers are little-endian.
+//
+//   File       := "CINECOL1" Table*
+//   Table      := "TBL" u8 nameLen name u16 columnCount ColumnDesc* Chunk* u32 0
+//   ColumnDesc := u8 nameLen name u8 type        (1 = int64, 2 = dict string, 3 = uint8)
+//   Chunk      := u32 rowCount ColumnData*       (one per column, in declaration order)
+//     int64       : rowCount * i64
+//     uint8       : rowCount * u8
+//     dict string : u32 dictSize (u32 len bytes)*dictSize, then rowCount * u32 codes
+//
+// String dictionaries are local to each chunk, so a reader only ever holds one
+// chunk in memory. A table ends with a chunk whose rowCount is 0.
+class ColumnarWriter {
+public:
+    enum ColumnType : uint8_t { INT64 = 1, DICT_STRING = 2, UINT8 = 3 };
+    static const size_t CHUNK_ROWS = 4096;
 
-    void updateBooking(int index, const Schedule& newSchedule, const string& newSeat, double newPrice, const string& newPaymentMode) {
-        if (index >= 0 && index < bookings.size()) {
-            Booking& booking = bookings[index];
-            freeSeat(booking.getMovieID(), booking.getSchedule().getDate(), booking.getSeat());
-            booking = Booking(
-                booking.getCustomerUsername(),
-                booking.getMovieID(),
-                newSchedule,
-                newSeat,
-                newPrice,
-                newPaymentMode
-            );
-            bookSeat(booking.getMovieID(), newSchedule.getDate(), newSeat);
-            saveData();
-        }
+private:
+    struct Column {
+        string name;
+        ColumnType type;
+        vector<int64_t> ints;
+        vector<uint32_t> codes;
+        vector<string> dictionary;
+        unordered_map<string, uint32_t> dictionaryIndex;
+    };
+
+    ofstream out;
+    vector<Column> columns;
+    size_t pendingRows = 0;
+    size_t totalRows = 0;
+    bool tableOpen = false;
+
+    void writeU8(uint8_t v) { out.put(static_cast<char>(v)); }
+    void writeU16(uint16_t v) { for (int i = 0; i < 2; i++) writeU8((v >> (8 * i)) & 0xFF); }
+    void writeU32(uint32_t v) { for (int i = 0; i < 4; i++) writeU8((v >> (8 * i)) & 0xFF); }
+    void writeI64(int64_t v) {
+        uint64_t bits = static_cast<uint64_t>(v);
+        for (int i = 0; i < 8; i++) writeU8((bits >> (8 * i)) & 0xFF);
+    }
+    void writeName(const string& name) {
+        uint8_t len = static_cast<uint8_t>(min<size_t>(name.size(), 255));
+        writeU8(len);
+        out.write(name.data(), len);
     }
 
-    string getValidSeat(int movieID, const string& date) {
-        string seat;
-        bool validSeat = false;
-        
-        while (!validSeat) {
-            cout << "Enter seat (e.g., A1) or '0' to cancel: ";
-            getline(cin, seat);
-            transform(seat.begin(), seat.end(), seat.begin(), ::toupper);
-            
-            if (seat == "0") {
-                validSeat = true;
-                seat = "";
-            } else if (isSeatAvailable(movieID, date, seat)) {
-                validSeat = true;
+    void flushChunk() {
+        if (pendingRows == 0) return;
+        writeU32(pendingRows);
+        for (auto& col : columns) {
+            if (col.type == DICT_STRING) {
+                writeU32(col.dictionary.size());
+                for (const auto& value : col.dictionary) {
+                    writeU32(value.size());
+                    out.write(value.data(), value.size());
+                }
+                for (uint32_t code : col.codes) writeU32(code);
+                col.codes.clear();
+                col.dictionary.clear();
+                col.dictionaryIndex.clear();
             } else {
-                cout << "Invalid or already booked seat. Please try again." << endl;
+                for (int64_t v : col.ints) {
+                    if (col.type == UINT8) writeU8(static_cast<uint8_t>(v));
+                    else writeI64(v);
+                }
+                col.ints.clear();
             }
         }
-        return seat;
+        pendingRows = 0;
     }
 
-    Schedule getValidSchedule() {
-        string date, time;
-        bool valid = false;
-        
-        while (!valid) {
-            cout << "Enter date (YYYY-MM-DD): ";
-            getline(cin, date);
-            if (!isValidDate(date)) {
-                cout << "Invalid date format. Please use YYYY-MM-DD." << endl;
-                continue;
-            }
+public:
+    explicit ColumnarWriter(const string& path) : out(path, ios::binary) {
+        if (out.is_open()) out.write("CINECOL1", 8);
+    }
 
-            cout << "Enter time (HH:MM): ";
-            getline(cin, time);
-            if (!isValidTime(time)) {
-                cout << "Invalid time format. Please use HH:MM." << endl;
-                continue;
-            }
+    bool isOpen() const { return out.is_open(); }
+    size_t rowsWritten() const { return totalRows; }
 
-            valid = true;
+    void beginTable(const string& name, const vector<pair<string, ColumnType>>& schema) {
+        endTable();
+        columns.clear();
+        out.write("TBL", 3);
+        writeName(name);
+        writeU16(schema.size());
+        for (const auto& field : schema) {
+            writeName(field.first);
+            writeU8(field.second);
+            Column col;
+            col.name = field.first;
+            col.type = field.second;
+            columns.push_back(move(col));
         }
-        return Schedule(date, time);
+        tableOpen = true;
     }
-};
 
-// Initialize static member
-CinemaBookingSystem* CinemaBookingSystem::instance = nullptr;
+    // Values are set column by column for the current row, then endRow() is called
+    void setInt(size_t column, int64_t value) { columns[column].ints.push_back(value); }
 
-// Customer method implementations
-void Customer::bookTicket() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    
-    if (movies.empty()) {
-        cout << "No movies available for booking." << endl;
-        return;
-    }
-    
-    cout << "\n=== Available Movies ===" << endl;
-    for (size_t i = 0; i < movies.size(); i++) {
-        cout << i+1 << ".";
-        movies[i].displayDetails();
+    void setString(size_t column, const string& value) {
+        Column& col = columns[column];
+        auto it = col.dictionaryIndex.find(value);
+        if (it == col.dictionaryIndex.end()) {
+            it = col.dictionaryIndex.insert({value, static_cast<uint32_t>(col.dictionary.size())}).first;
+            col.dictionary.push_back(value);
+        }
+        col.codes.push_back(it->second);
     }
-    
-    cout << "Enter movie ID to book (0 to cancel): ";
-    int movieChoice = getValidChoice(0, movies.size());
-    
-    if (movieChoice == 0) {
-        cout << "Booking cancelled." << endl;
-        return;
+
+    void endRow() {
+        pendingRows++;
+        totalRows++;
+        if (pendingRows == CHUNK_ROWS) flushChunk();
     }
-    
-    Movie& selectedMovie = movies[movieChoice - 1];
-    const vector<Schedule>& schedules = selectedMovie.getSchedules();
-    
-    if (schedules.empty()) {
-        cout << "No schedules available for this movie." << endl;
-        return;
+
+    void endTable() {
+        if (!tableOpen) return;
+        flushChunk();
+        writeU32(0);
+        tableOpen = false;
     }
-    
-    cout << "\nAvailable schedules for " << selectedMovie.getTitle() << ":" << endl;
-    for (size_t i = 0; i < schedules.size(); i++) {
-        cout << i+1 << ". ";
-        schedules[i].display();
-        cout << endl;
+
+    ~ColumnarWriter() { endTable(); }
+};
+
+// Flushes a file's data, or on POSIX a directory's entries, to the disk
+bool syncPath(const string& path) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    bool synced = FlushFileBuffers(handle);
+    CloseHandle(handle);
+    return synced;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+// Moves a finished temporary file over path in one step (an atomic replace
+// on POSIX, MoveFileEx with replace on Windows). If it fails, the old file
+// is left as it was. The data reaches the disk before the rename, and on
+// POSIX the rename reaches it before this returns, so after a power loss
+// path holds either the old or the new content and a later rename never
+// lands ahead of this one. NTFS journals the rename itself.
+bool replaceFile(const string& temporary, const string& path) {
+    if (!syncPath(temporary)) return false;
+    error_code error;
+    filesystem::rename(temporary, path, error);
+    if (error) return false;
+#ifndef _WIN32
+    string directory = filesystem::path(path).parent_path().string();
+    syncPath(directory.empty() ? "." : directory);
+#endif
+    return true;
+}
+
+// Replaces path with content through "<path>.tmp", so readers and crashes
+// see either the old file or the new one. No checksum sidecar is written.
+bool writeWholeFile(const string& path, const string& content) {
+    {
+        ofstream out(path + ".tmp", ios::binary | ios::trunc);
+        if (!out.is_open() || !(out << content).flush()) return false;
     }
-    
-    cout << "Enter schedule number (0 to cancel): ";
-    int scheduleChoice = getValidChoice(0, schedules.size());
-    
-    if (scheduleChoice == 0) {
-        cout << "Booking cancelled." << endl;
-        return;
+    return replaceFile(path + ".tmp", path);
+}
+
+// Block checksums for the data files. Every save writes a "<file>.sum"
+// sidecar next to the file:
+//
+//   #SUM,<linesPerBlock>,<blockCount>
+//   <FNV-1a of block 0 in hex>
+//   ...
+//
+// where a block is linesPerBlock consecutive lines, newlines included. At
+// startup all blocks of all files are hashed on a pool of threads and any
+// block that does not match is moved to "<file>.quarantine", so the loaders
+// only ever see verified data. Files without a sidecar are loaded as before.
+//
+// A save writes the file and sidecar as temporaries and puts them in place
+// in three renames: sidecar to "<file>.sum.new", file, sidecar to
+// "<file>.sum". If a crash leaves a .sum.new behind, the next scan keeps it
+// when the file matches it and drops it otherwise, so file and sidecar
+// always agree and a valid file is never mistaken for a damaged one.
+class IntegrityScanner {
+public:
+    static const size_t LINES_PER_BLOCK = 64;
+
+    struct Result {
+        string file;
+        bool checked = false;       // false if the file had no usable sidecar
+        size_t blocks = 0;
+        size_t badBlocks = 0;
+        vector<string> quarantined; // lines taken out of the file
+    };
+
+    static uint64_t fnv1a(const char* data, size_t size) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
     }
-    
-    Schedule selectedSchedule = schedules[scheduleChoice - 1];
-    
-    // Display theater layout
-    cout << "\n\t\t=== THEATER LAYOUT ===" << endl;
-    system->displaySeatLayout(selectedMovie.getMovieID(), selectedSchedule.getDate());
-    
-    string seat = system->getValidSeat(selectedMovie.getMovieID(), selectedSchedule.getDate());
-    if (seat.empty()) {
-        cout << "Booking cancelled." << endl;
-        return;
+
+    // Replaces path with content, and its sidecar with content's sums
+    static bool writeFile(const string& path, const string& content) {
+        ofstream out(path + ".tmp", ios::binary | ios::trunc);
+        if (!out.is_open()) return false;
+        out << content;
+        out.close();
+        if (!out) return false;
+        FileBlocks file;
+        file.content = content;
+        splitLines(file);
+        vector<uint64_t> sums;
+        for (size_t b = 0; b < file.blockCount(); b++) sums.push_back(file.blockHash(b));
+        return commit(path, sums);
     }
-    
-    // Show selection confirmation
-    cout << "\n\tYou have selected: " << seat << endl;
-    cout << "\tPrice: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
-    cout << "\t----------------------------" << endl;
-    
-    cout << "\n=== Booking Summary ===" << endl;
-    cout << "Movie: " << selectedMovie.getTitle() << endl;
-    cout << "Date: " << selectedSchedule.getDate() << endl;
-    cout << "Time: " << selectedSchedule.getTime() << endl;
-    cout << "Seat: " << seat << endl;
-    cout << "Price: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
-    
-    if (getConfirmation("Confirm booking details?")) {
-        string paymentMode = getValidPaymentMode();
-        
-        cout << "\nPayment Summary:" << endl;
-        cout << "Amount to Pay: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
-        cout << "Payment Mode: " << paymentMode << endl;
-        
-        if (getConfirmation("Confirm payment?")) {
-            system->addBooking(Booking(getUsername(), selectedMovie.getMovieID(), selectedSchedule, seat, selectedMovie.getPrice(), paymentMode));
-            cout << "\n\t*********************************" << endl;
-            cout << "\t*                               *" << endl;
-            cout << "\t*      BOOKING CONFIRMED!       *" << endl;
-            cout << "\t*                               *" << endl;
-            cout << "\t*********************************" << endl;
-            cout << "\nPayment of ₱" << fixed << setprecision(2) << selectedMovie.getPrice() 
-                 << " via " << paymentMode << " has been processed." << endl;
-        } else {
-            cout << "Payment cancelled. Booking not confirmed." << endl;
+
+    // Puts "<path>.tmp" in place with the given block sums (see above)
+    static bool commit(const string& path, const vector<uint64_t>& sums) {
+        {
+            ofstream sumFile(path + ".sum.tmp", ios::trunc);
+            if (!sumFile.is_open()) return false;
+            sumFile << "#SUM," << LINES_PER_BLOCK << "," << sums.size() << '\n' << hex;
+            for (uint64_t sum : sums) sumFile << sum << '\n';
+            if (!sumFile.flush()) return false;
         }
-    } else {
-        cout << "Booking cancelled." << endl;
+        return replaceFile(path + ".sum.tmp", path + ".sum.new") && replaceFile(path + ".tmp", path) &&
+               replaceFile(path + ".sum.new", path + ".sum");
     }
-}
 
-void Customer::viewBookings() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    const vector<Booking>& bookings = system->getBookings();
-    const vector<Movie>& movies = system->getMovies();
-    
-    cout << "\n=== My Bookings ===" << endl;
-    
-    bool hasBookings = false;
-    for (const auto& booking : bookings) {
-        if (booking.getCustomerUsername() == getUsername()) {
-            booking.displayDetails(movies);
-            hasBookings = true;
+    static vector<Result> scan(const vector<string>& paths) {
+        vector<FileBlocks> files(paths.size());
+        vector<Result> results(paths.size());
+        vector<pair<size_t, size_t>> jobs; // (file, block)
+        for (size_t f = 0; f < paths.size(); f++) {
+            results[f].file = paths[f];
+            settle(paths[f]);
+            if (!readBlocks(paths[f], files[f]) || !readSums(paths[f] + ".sum", files[f].expected)) continue;
+            results[f].checked = true;
+            results[f].blocks = files[f].blockCount();
+            for (size_t b = 0; b < files[f].blockCount(); b++) jobs.push_back({f, b});
+        }
+
+        // Hash every block of every file on a shared pool of threads
+        vector<vector<uint64_t>> hashes(files.size());
+        for (size_t f = 0; f < files.size(); f++) hashes[f].resize(files[f].blockCount());
+        atomic<size_t> nextJob(0);
+        auto worker = [&]() {
+            for (size_t j = nextJob++; j < jobs.size(); j = nextJob++) {
+                hashes[jobs[j].first][jobs[j].second] = files[jobs[j].first].blockHash(jobs[j].second);
+            }
+        };
+        size_t threadCount = min<size_t>(max(1u, thread::hardware_concurrency()), jobs.size() / 16 + 1);
+        vector<thread> pool;
+        for (size_t t = 1; t < threadCount; t++) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+
+        for (size_t f = 0; f < files.size(); f++) {
+            if (!results[f].checked) continue;
+            string kept;
+            for (size_t b = 0; b < files[f].blockCount(); b++) {
+                const vector<uint64_t>& expected = files[f].expected;
+                if (b < expected.size() && expected[b] == hashes[f][b]) {
+                    kept += files[f].block(b);
+                    continue;
+                }
+                results[f].badBlocks++;
+                istringstream lines(files[f].block(b));
+                string line;
+                while (getline(lines, line)) results[f].quarantined.push_back(line);
+            }
+            // Blocks missing from a truncated file count as damaged too
+            if (files[f].expected.size() > files[f].blockCount()) {
+                results[f].badBlocks += files[f].expected.size() - files[f].blockCount();
+            }
+            if (results[f].badBlocks == 0) continue;
+
+            quarantine(paths[f], results[f].quarantined, "failed checksum");
+            writeFile(paths[f], kept);
         }
+        return results;
     }
-    
-    if (!hasBookings) {
-        cout << "You have no bookings." << endl;
+
+    // Appends lines to "<file>.quarantine" under a timestamped header
+    static void quarantine(const string& path, const vector<string>& lines, const string& reason) {
+        if (lines.empty()) return;
+        ofstream out(path + ".quarantine", ios::app);
+        time_t now = time(nullptr);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+        out << "# " << stamp << " " << lines.size() << " line(s) " << reason << '\n';
+        for (const auto& line : lines) out << line << '\n';
     }
-}
 
-void Customer::editBooking() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Booking>& bookings = system->getBookings();
-    vector<Movie>& movies = system->getMovies();
-    
-    cout << "\n=== My Bookings ===" << endl;
-    vector<int> userBookingIndices;
-    int count = 1;
-    
-    for (size_t i = 0; i < bookings.size(); i++) {
-        if (bookings[i].getCustomerUsername() == getUsername()) {
-            cout << count << ".";
-            bookings[i].displayDetails(movies);
-            userBookingIndices.push_back(i);
-            count++;
+private:
+    struct FileBlocks {
+        string content;
+        vector<size_t> lineStarts;
+        vector<uint64_t> expected;
+
+        size_t blockCount() const { return (lineStarts.size() + LINES_PER_BLOCK - 1) / LINES_PER_BLOCK; }
+        size_t blockBegin(size_t b) const { return lineStarts[b * LINES_PER_BLOCK]; }
+        size_t blockEnd(size_t b) const {
+            size_t next = (b + 1) * LINES_PER_BLOCK;
+            return next < lineStarts.size() ? lineStarts[next] : content.size();
         }
+        string block(size_t b) const { return content.substr(blockBegin(b), blockEnd(b) - blockBegin(b)); }
+        uint64_t blockHash(size_t b) const { return fnv1a(content.data() + blockBegin(b), blockEnd(b) - blockBegin(b)); }
+    };
+
+    static bool readBlocks(const string& path, FileBlocks& file) {
+        ifstream in(path, ios::binary);
+        if (!in.is_open()) return false;
+        ostringstream buffer;
+        buffer << in.rdbuf();
+        file.content = buffer.str();
+        splitLines(file);
+        return true;
     }
-    
-    if (userBookingIndices.empty()) {
-        cout << "You have no bookings to edit." << endl;
-        return;
+
+    static void splitLines(FileBlocks& file) {
+        for (size_t pos = 0; pos < file.content.size(); pos = file.content.find('\n', pos) + 1) {
+            file.lineStarts.push_back(pos);
+            if (file.content.find('\n', pos) == string::npos) break;
+        }
     }
-    
-    cout << "Enter booking number to edit (0 to cancel): ";
-    int bookingChoice = getValidChoice(0, userBookingIndices.size());
-    
-    if (bookingChoice == 0) {
-        cout << "Edit cancelled." << endl;
-        return;
+
+    // Resolves a save interrupted between its renames: a staged sidecar
+    // becomes the sidecar if the file was already replaced
+    static void settle(const string& path) {
+        vector<uint64_t> staged;
+        if (!readSums(path + ".sum.new", staged)) return;
+        FileBlocks file;
+        bool replaced = readBlocks(path, file) && file.blockCount() == staged.size();
+        for (size_t b = 0; replaced && b < staged.size(); b++) replaced = file.blockHash(b) == staged[b];
+        if (replaced) replaceFile(path + ".sum.new", path + ".sum");
+        else remove((path + ".sum.new").c_str());
     }
-    
-    int actualIndex = userBookingIndices[bookingChoice - 1];
-    Booking& bookingToEdit = bookings[actualIndex];
-    
-    Movie* selectedMovie = nullptr;
-    for (auto& movie : movies) {
-        if (movie.getMovieID() == bookingToEdit.getMovieID()) {
-            selectedMovie = &movie;
-            break;
+
+    static bool readSums(const string& path, vector<uint64_t>& sums) {
+        ifstream in(path);
+        string header;
+        if (!in.is_open() || !getline(in, header)) return false;
+        string prefix = "#SUM," + to_string(LINES_PER_BLOCK) + ",";
+        if (header.compare(0, prefix.size(), prefix) != 0) return false;
+        string line;
+        while (getline(in, line)) {
+            try {
+                sums.push_back(stoull(line, nullptr, 16));
+            } catch (...) {
+                sums.push_back(0);
+            }
         }
+        return true;
     }
-    
-    if (!selectedMovie) {
-        cout << "Error: Movie not found." << endl;
-        return;
-    }
-    
-    const vector<Schedule>& schedules = selectedMovie->getSchedules();
-    cout << "\nAvailable schedules for " << selectedMovie->getTitle() << ":" << endl;
-    for (size_t i = 0; i < schedules.size(); i++) {
-        cout << i+1 << ". ";
-        schedules[i].display();
-        cout << endl;
+};
+
+// Output file for the savers. Block sums are computed from the bytes as they
+// are written, so a save never reads its file back; the file goes to
+// "<path>.tmp" and commit() puts it and its sidecar in place. A file that is
+// never committed leaves the original untouched.
+class SummedFile : public ostream {
+private:
+    class SummingBuffer : public streambuf {
+    public:
+        filebuf file;
+        vector<uint64_t> sums;
+
+        // Closes the block in progress, if any
+        void finish() {
+            if (blockBytes > 0) sums.push_back(hash);
+            blockBytes = 0;
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+            char ch = traits_type::to_char_type(c);
+            return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+        }
+
+        streamsize xsputn(const char* data, streamsize size) override {
+            streamsize put = file.sputn(data, size);
+            for (streamsize i = 0; i < put; i++) {
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+                blockBytes++;
+                if (data[i] == '\n' && ++lines == IntegrityScanner::LINES_PER_BLOCK) {
+                    sums.push_back(hash);
+                    hash = FNV_OFFSET;
+                    lines = 0;
+                    blockBytes = 0;
+                }
+            }
+            written += put;
+            return put;
+        }
+
+        // Only tellp is supported
+        pos_type seekoff(off_type offset, ios_base::seekdir dir, ios_base::openmode) override {
+            return offset == 0 && dir == ios_base::cur ? pos_type(written) : pos_type(off_type(-1));
+        }
+
+        int sync() override { return file.pubsync(); }
+
+    private:
+        static const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+        uint64_t hash = FNV_OFFSET;
+        size_t lines = 0;
+        streamoff blockBytes = 0;
+        streamoff written = 0;
+    };
+
+    string path;
+    SummingBuffer buffer;
+
+public:
+    explicit SummedFile(const string& target) : ostream(nullptr), path(target) {
+        rdbuf(&buffer);
+        if (!buffer.file.open(path + ".tmp", ios::out | ios::binary | ios::trunc)) setstate(ios::badbit);
     }
-    
-    cout << "Enter new schedule number (0 to keep current): ";
-    int scheduleChoice = getValidChoice(0, schedules.size());
-    
-    Schedule newSchedule = bookingToEdit.getSchedule();
-    if (scheduleChoice > 0) {
-        newSchedule = schedules[scheduleChoice - 1];
+
+    bool is_open() const { return buffer.file.is_open(); }
+
+    bool commit() {
+        if (!buffer.file.is_open()) return false;
+        bool written = good() && buffer.file.close() != nullptr;
+        buffer.finish();
+        return written && IntegrityScanner::commit(path, buffer.sums);
     }
-    
-    system->displaySeatLayout(selectedMovie->getMovieID(), newSchedule.getDate());
-    
-    cout << "Enter new seat (current: " << bookingToEdit.getSeat() << ", enter 0 to keep current): ";
-    string newSeat = system->getValidSeat(selectedMovie->getMovieID(), newSchedule.getDate());
-    if (newSeat.empty()) {
-        newSeat = bookingToEdit.getSeat();
+};
+
+// Advisory lock on LOCK_FILE held while an instance reads or rewrites the
+// data files, so several instances can share one data directory. Reentrant
+// within a thread and exclusive between threads of a process (the log
+// shipper reads the files from its own thread); the OS releases it if the
+// process dies.
+class DataLock {
+private:
+#ifdef _WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    int depth = 0;
+    mutex depthMutex;
+    recursive_mutex owner; // held by the thread inside the lock
+
+    DataLock() = default;
+
+public:
+    static DataLock& get() {
+        static DataLock lock;
+        return lock;
     }
-    
-    double newPrice = selectedMovie->getPrice();
-    
-    cout << "\n=== Updated Booking Summary ===" << endl;
-    cout << "Movie: " << selectedMovie->getTitle() << endl;
-    cout << "Date: " << newSchedule.getDate() << endl;
-    cout << "Time: " << newSchedule.getTime() << endl;
-    cout << "Seat: " << newSeat << endl;
-    cout << "Price: ₱" << fixed << setprecision(2) << newPrice << endl;
-    cout << "Current Payment Mode: " << bookingToEdit.getPaymentMode() << endl;
-    
-    string newPaymentMode = bookingToEdit.getPaymentMode();
-    if (getConfirmation("Would you like to change the payment mode?")) {
-        newPaymentMode = getValidPaymentMode();
+
+    void acquire() {
+        owner.lock();
+        lock_guard<mutex> guard(depthMutex);
+        if (depth++ > 0) return;
+#ifdef _WIN32
+        if (handle == INVALID_HANDLE_VALUE) {
+            handle = CreateFileA(LOCK_FILE.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                 nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        }
+        OVERLAPPED region = {};
+        if (handle != INVALID_HANDLE_VALUE) LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &region);
+#else
+        if (fd < 0) fd = open(LOCK_FILE.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd >= 0) {
+            while (flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+        }
+#endif
     }
-    
-    cout << "\nFinal Payment Summary:" << endl;
-    cout << "Amount to Pay: ₱" << fixed << setprecision(2) << newPrice << endl;
-    cout << "Payment Mode: " << newPaymentMode << endl;
-    
-    if (getConfirmation("Confirm changes?")) {
-        system->updateBooking(actualIndex, newSchedule, newSeat, newPrice, newPaymentMode);
-        cout << "Booking updated successfully!" << endl;
-        if (newPaymentMode != bookingToEdit.getPaymentMode()) {
-            cout << "Payment mode has been updated to: " << newPaymentMode << endl;
+
+    void release() {
+        {
+            lock_guard<mutex> guard(depthMutex);
+            if (depth == 0) return;
+            if (--depth == 0) {
+#ifdef _WIN32
+                OVERLAPPED region = {};
+                if (handle != INVALID_HANDLE_VALUE) UnlockFileEx(handle, 0, 1, 0, &region);
+#else
+                if (fd >= 0) flock(fd, LOCK_UN);
+#endif
+            }
         }
-    } else {
-        cout << "Edit cancelled." << endl;
+        owner.unlock();
     }
+
+    class Guard {
+    public:
+        Guard() { DataLock::get().acquire(); }
+        ~Guard() { DataLock::get().release(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+};
+
+inline long processID() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return getpid();
+#endif
 }
 
-void Customer::cancelBooking() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Booking>& bookings = system->getBookings();
-    vector<Movie>& movies = system->getMovies();
-    
-    cout << "\n=== My Bookings ===" << endl;
-    vector<int> userBookingIndices;
-    int count = 1;
-    
-    for (size_t i = 0; i < bookings.size(); i++) {
-        if (bookings[i].getCustomerUsername() == getUsername()) {
-            cout << count << ".";
-            bookings[i].displayDetails(movies);
-            userBookingIndices.push_back(i);
-            count++;
+// Hands out booking IDs that are never reused: not across restarts, edits or
+// instances sharing the data directory. BOOKING_ID_FILE holds the high-water
+// mark. An instance advances it by PROCESS_ID_BLOCK under DataLock and deals
+// the reserved range out to its threads THREAD_ID_BLOCK at a time, so most
+// allocations are a thread-local increment. IDs left in a thread's block
+// when the process exits are skipped, never reissued.
+class BookingIDAllocator {
+private:
+    struct Block {
+        int next = 0;
+        int end = 0;
+    };
+
+    mutex reserveMutex;
+    int reservedNext = 0;
+    int reservedEnd = 0;
+    atomic<int> highestSeen{0};
+
+    BookingIDAllocator() = default;
+
+    // Called under DataLock and reserveMutex. The mark is replaced through a
+    // temporary file: truncated in place, a crash could leave it empty and
+    // the next instance would hand out IDs again.
+    void reserveFromFile() {
+        int mark = 1;
+        ifstream in(BOOKING_ID_FILE);
+        if (!(in >> mark) || mark < 1) mark = 1;
+        mark = max(mark, highestSeen + 1);
+        in.close();
+        writeWholeFile(BOOKING_ID_FILE, to_string(mark + PROCESS_ID_BLOCK) + "\n");
+        reservedNext = mark;
+        reservedEnd = mark + PROCESS_ID_BLOCK;
+    }
+
+    Block takeBlock() {
+        unique_lock<mutex> lock(reserveMutex);
+        if (reservedEnd - reservedNext < THREAD_ID_BLOCK) {
+            lock.unlock();
+            DataLock::Guard guard; // taken before reserveMutex, as commits do
+            lock.lock();
+            if (reservedEnd - reservedNext < THREAD_ID_BLOCK) reserveFromFile();
         }
+        Block block{reservedNext, reservedNext + THREAD_ID_BLOCK};
+        reservedNext = block.end;
+        return block;
     }
-    
-    if (userBookingIndices.empty()) {
-        cout << "You have no bookings to cancel." << endl;
-        return;
+
+public:
+    static BookingIDAllocator& get() {
+        static BookingIDAllocator allocator;
+        return allocator;
     }
-    
-    cout << "Enter booking number to cancel (0 to cancel): ";
-    int bookingChoice = getValidChoice(0, userBookingIndices.size());
-    
-    if (bookingChoice == 0) {
-        cout << "Cancellation aborted." << endl;
-        return;
+
+    int next() {
+        static thread_local Block block;
+        if (block.next == block.end) block = takeBlock();
+        return block.next++;
     }
-    
-    int actualIndex = userBookingIndices[bookingChoice - 1];
-    
-    if (getConfirmation("Are you sure you want to cancel this booking?")) {
-        system->removeBooking(actualIndex);
-        cout << "Booking cancelled successfully." << endl;
-    } else {
-        cout << "Cancellation aborted." << endl;
+
+    // Hands the part of the reservation no thread has taken back to the
+    // file, if no other instance reserved IDs after this one
+    void returnUnused() {
+        DataLock::Guard guard;
+        lock_guard<mutex> lock(reserveMutex);
+        int mark = 0;
+        ifstream in(BOOKING_ID_FILE);
+        if (reservedNext == reservedEnd || !(in >> mark) || mark != reservedEnd) return;
+        in.close();
+        if (writeWholeFile(BOOKING_ID_FILE, to_string(reservedNext) + "\n")) reservedEnd = reservedNext;
     }
-}
 
-void Customer::displayMenu() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    bool logout = false;
-    
-    while (!logout) {
-        cout << "\n\n\t╔═══════════════════════════════════╗" << endl;
-        cout << "\t║          Customer Menu            ║" << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << "\t║  1. Book Ticket                   ║" << endl;
-        cout << "\t║  2. View My Bookings              ║" << endl;
-        cout << "\t║  3. Edit Booking                  ║" << endl;
-        cout << "\t║  4. Cancel Booking                ║" << endl;
-        cout << "\t║  5. Logout                        ║" << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
-        
-        int choice = getValidChoice(1, 5);
+    // Records an ID found in the data files, so a data directory without
+    // BOOKING_ID_FILE continues after its highest booking ID
+    void observe(int id) {
+        int seen = highestSeen;
+        while (id > seen && !highestSeen.compare_exchange_weak(seen, id)) {}
+    }
+};
 
-        switch (choice) {
-            case 1:
-                cout << "\n";
-                bookTicket();
-                break;
-            case 2:
-                cout << "\n";
-                viewBookings();
-                break;
-            case 3:
-                cout << "\n";
-                editBooking();
-                break;
+// Tells whether JOURNAL_FILE may have changed since the last call. On Linux
+// this drains an inotify watch on the data directory, so an idle instance does
+// not touch the journal at all; elsewhere it compares the file size.
+class JournalWatcher {
+private:
+#ifdef __linux__
+    int inotifyFd = -1;
+#endif
+    streamoff lastSize = -1;
+
+    static streamoff fileSize() {
+        ifstream in(JOURNAL_FILE, ios::binary | ios::ate);
+        return in.is_open() ? static_cast<streamoff>(in.tellg()) : 0;
+    }
+
+public:
+    JournalWatcher() {
+#ifdef __linux__
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0 && inotify_add_watch(inotifyFd, ".", IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+#endif
+    }
+
+    ~JournalWatcher() {
+#ifdef __linux__
+        if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    }
+
+    JournalWatcher(const JournalWatcher&) = delete;
+    JournalWatcher& operator=(const JournalWatcher&) = delete;
+
+    bool changed() {
+#ifdef __linux__
+        if (inotifyFd >= 0) {
+            bool touched = false;
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char* at = buffer; at < buffer + length;) {
+                    inotify_event* event = reinterpret_cast<inotify_event*>(at);
+                    if (event->len > 0 && JOURNAL_FILE == event->name) touched = true;
+                    at += sizeof(inotify_event) + event->len;
+                }
+            }
+            return touched;
+        }
+#endif
+        streamoff size = fileSize();
+        bool touched = size != lastSize;
+        lastSize = size;
+        return touched;
+    }
+};
+
+// Rebuilds the live bookings from the journal alone. Every journal generation
+// starts with a checkpoint (one BASE record per booking, then CHECKPOINT) and
+// then logs each booking change. Bookings are committed by the journal, so
+// every load replays it; that also recovers bookings.txt after a crash
+// damaged it. Each record's partition key is the showtime in its booking
+// line. Records of different showtimes never interact, so parsing (by chunk of
+// the file) and replay (by showtime) both run on a thread pool. An UPD becomes
+// a DEL in its old showtime and an ADD in its new one.
+class JournalReplayer {
+public:
+    using Key = pair<int, string>; // movieID, "date time"
+
+    struct Record {
+        uint64_t seq;   // position in the journal
+        bool add;
+        bool base;      // part of the checkpoint rather than a later change
+        string ticket;  // seat + customer, identifies a booking within its showtime
+        string booking; // booking line as in bookings.txt
+    };
+
+    struct Result {
+        bool checkpointed = false;     // the generation starts with a checkpoint
+        size_t records = 0;
+        size_t malformed = 0;
+        map<Key, vector<Record>> live; // bookings left per showtime, in journal order
+        set<Key> changed;              // showtimes with changes after the checkpoint
+    };
+
+    static Result replay(const string& journal, size_t threads) {
+        Result result;
+        size_t bodyStart = journal.find('\n');
+        if (journal.rfind("#JOURNAL,", 0) != 0 || bodyStart == string::npos) return result;
+        threads = max<size_t>(1, threads);
+
+        // Split the body into chunks at line boundaries, a few per thread
+        vector<pair<size_t, size_t>> chunks;
+        size_t chunkSize = max<size_t>(1 << 16, (journal.size() - bodyStart) / (threads * 4) + 1);
+        for (size_t begin = bodyStart + 1; begin < journal.size();) {
+            size_t end = journal.find('\n', min(journal.size() - 1, begin + chunkSize));
+            end = end == string::npos ? journal.size() : end + 1;
+            chunks.push_back({begin, end});
+            begin = end;
+        }
+
+        vector<Parsed> parsed(chunks.size());
+        runPool(chunks.size(), threads, [&](size_t c) {
+            parseChunk(journal, chunks[c].first, chunks[c].second, static_cast<uint64_t>(c) << 40, parsed[c]);
+        });
+
+        // Concatenate each showtime's records in chunk order
+        for (auto& chunk : parsed) {
+            result.checkpointed = result.checkpointed || chunk.checkpoint;
+            result.records += chunk.records;
+            result.malformed += chunk.malformed;
+            for (auto& partition : chunk.partitions) {
+                vector<Record>& records = result.live[partition.first];
+                move(partition.second.begin(), partition.second.end(), back_inserter(records));
+            }
+        }
+
+        vector<vector<Record>*> partitions;
+        for (auto& partition : result.live) {
+            partitions.push_back(&partition.second);
+            if (any_of(partition.second.begin(), partition.second.end(), [](const Record& r) { return !r.base; })) {
+                result.changed.insert(partition.first);
+            }
+        }
+        runPool(partitions.size(), threads, [&](size_t p) { replayPartition(*partitions[p]); });
+        for (auto it = result.live.begin(); it != result.live.end();) {
+            it = it->second.empty() ? result.live.erase(it) : next(it);
+        }
+        return result;
+    }
+
+    // Reads the showtime key and ticket out of a booking line
+    // (id,customer,movieID,date,time,seat,price,payment)
+    static bool describe(const string& booking, Key& key, string& ticket) {
+        size_t fields[8];
+        size_t count = 0;
+        for (size_t pos = 0; count < 8; pos++) {
+            fields[count++] = pos;
+            pos = booking.find(',', pos);
+            if (pos == string::npos) break;
+        }
+        if (count != 8) return false;
+        auto field = [&](int f) { return booking.substr(fields[f], fields[f + 1] - fields[f] - 1); };
+        try {
+            key.first = stoi(field(2));
+        } catch (...) {
+            return false;
+        }
+        key.second = field(3) + " " + field(4);
+        ticket = field(5) + "," + field(1);
+        return true;
+    }
+
+    // Splits an UPD entry into the old and the new booking line
+    static bool splitUpdate(const string& entry, string& before, string& after) {
+        size_t split = 0;
+        for (int f = 0; f < 8 && split != string::npos; f++) split = entry.find(',', split + (f > 0));
+        if (split == string::npos) return false;
+        before = entry.substr(0, split);
+        after = entry.substr(split + 1);
+        return true;
+    }
+
+    // Runs job(0..count-1) on up to `threads` threads
+    template <typename Job>
+    static void runPool(size_t count, size_t threads, Job job) {
+        atomic<size_t> nextJob(0);
+        auto worker = [&]() {
+            for (size_t j = nextJob++; j < count; j = nextJob++) job(j);
+        };
+        vector<thread> pool;
+        for (size_t t = 1; t < min(threads, count); t++) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+    }
+
+private:
+    struct Parsed {
+        bool checkpoint = false;
+        size_t records = 0;
+        size_t malformed = 0;
+        map<Key, vector<Record>> partitions;
+    };
+
+    static void parseChunk(const string& journal, size_t begin, size_t end, uint64_t seqBase, Parsed& out) {
+        uint64_t seq = seqBase;
+        for (size_t lineStart = begin; lineStart < end;) {
+            size_t lineEnd = journal.find('\n', lineStart);
+            if (lineEnd == string::npos || lineEnd >= end) break; // torn last line
+            string line = journal.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            seq++;
+            size_t opStart = line.find(',') + 1; // 0 if the line has no comma
+            if (opStart == 0) continue;
+            size_t opEnd = line.find(',', opStart);
+            string op = line.substr(opStart, opEnd == string::npos ? string::npos : opEnd - opStart);
+            string rest = opEnd == string::npos ? "" : line.substr(opEnd + 1);
+
+            if (op == "CHECKPOINT") {
+                out.checkpoint = true;
+                continue;
+            }
+            vector<pair<bool, string>> changes; // (add, booking line)
+            if (op == "BASE" || op == "ADD") {
+                changes.push_back({true, rest});
+            } else if (op == "DEL") {
+                changes.push_back({false, rest});
+            } else if (op == "UPD") {
+                string before, after;
+                if (!splitUpdate(rest, before, after)) {
+                    out.malformed++;
+                    continue;
+                }
+                changes.push_back({false, before});
+                changes.push_back({true, after});
+            } else {
+                continue; // USER, CATALOG: not booking changes
+            }
+
+            out.records++;
+            for (auto& change : changes) {
+                Record record{seq, change.first, op == "BASE", "", std::move(change.second)};
+                Key key;
+                if (!describe(record.booking, key, record.ticket)) {
+                    out.malformed++;
+                    continue;
+                }
+                out.partitions[key].push_back(std::move(record));
+            }
+        }
+    }
+
+    // Leaves only the bookings still present after every record of one showtime
+    static void replayPartition(vector<Record>& records) {
+        unordered_map<string, size_t> live; // ticket -> index into records
+        for (size_t i = 0; i < records.size(); i++) {
+            if (records[i].add) live.emplace(records[i].ticket, i);
+            else live.erase(records[i].ticket);
+        }
+        vector<size_t> kept;
+        for (const auto& entry : live) kept.push_back(entry.second);
+        sort(kept.begin(), kept.end());
+        vector<Record> survivors;
+        for (size_t i : kept) survivors.push_back(std::move(records[i]));
+        records = std::move(survivors);
+    }
+};
+
+// One fixed-size run of booking slots. A slot is empty once its booking is
+// cancelled, so the positions of the others do not move.
+using BookingChunk = vector<optional<Booking>>;
+
+// Walks the bookings of a list of chunks in commit order, skipping empty
+// slots and, if hidden is given, the bookings of those movies
+template <class ChunkPtr>
+class BookingCursor {
+private:
+    const vector<ChunkPtr>* chunks;
+    size_t chunk;
+    size_t slot = 0;
+    const set<int>* hidden;
+
+    void settle() {
+        for (; chunk < chunks->size(); chunk++, slot = 0) {
+            const BookingChunk& current = *(*chunks)[chunk];
+            for (; slot < current.size(); slot++) {
+                if (current[slot] && (!hidden || !hidden->count(current[slot]->getMovieID()))) return;
+            }
+        }
+    }
+
+public:
+    using iterator_category = forward_iterator_tag;
+    using value_type = Booking;
+    using difference_type = ptrdiff_t;
+    using pointer = const Booking*;
+    using reference = const Booking&;
+
+    BookingCursor(const vector<ChunkPtr>* chunks, size_t chunk, const set<int>* hidden)
+        : chunks(chunks), chunk(chunk), hidden(hidden) { settle(); }
+
+    reference operator*() const { return *(*(*chunks)[chunk])[slot]; }
+    pointer operator->() const { return &**this; }
+    BookingCursor& operator++() {
+        slot++;
+        settle();
+        return *this;
+    }
+    BookingCursor operator++(int) {
+        BookingCursor before = *this;
+        ++*this;
+        return before;
+    }
+    bool operator==(const BookingCursor& other) const { return chunk == other.chunk && slot == other.slot; }
+    bool operator!=(const BookingCursor& other) const { return !(*this == other); }
+};
+
+// The bookings of one snapshot: the chunks of its version, read-only, minus
+// the bookings of movies deleted by then. size() counts as it walks.
+class BookingList {
+private:
+    vector<shared_ptr<const BookingChunk>> chunks;
+    set<int> hidden;
+
+public:
+    using const_iterator = BookingCursor<shared_ptr<const BookingChunk>>;
+
+    BookingList(vector<shared_ptr<const BookingChunk>> chunks, set<int> hidden)
+        : chunks(std::move(chunks)), hidden(std::move(hidden)) {}
+
+    const_iterator begin() const { return const_iterator(&chunks, 0, &hidden); }
+    const_iterator end() const { return const_iterator(&chunks, chunks.size(), &hidden); }
+    bool empty() const { return begin() == end(); }
+    size_t size() const { return distance(begin(), end()); }
+};
+
+// The live bookings in commit order, in chunks of CHUNK_SIZE slots that
+// snapshots share instead of copying. A commit changes a chunk in place
+// unless a snapshot still holds it, in which case it changes a copy: one
+// chunk per commit at most, however many bookings there are. Cancelling
+// empties a slot; once empty slots outnumber bookings, the store is compacted
+// and positions change, so a position is only good until the next erase.
+// Each customer's positions are indexed, so their bookings are found without
+// a pass over everyone's.
+class BookingStore {
+public:
+    static const size_t CHUNK_SIZE = 1024;
+    using const_iterator = BookingCursor<shared_ptr<BookingChunk>>;
+
+private:
+    vector<shared_ptr<BookingChunk>> chunks;
+    size_t live = 0;
+    map<string, vector<size_t>> byCustomer; // username -> positions, ascending
+
+    BookingChunk& writable(size_t chunk) {
+        if (chunks[chunk].use_count() > 1) chunks[chunk] = make_shared<BookingChunk>(*chunks[chunk]);
+        return *chunks[chunk];
+    }
+
+    void index(const string& username, size_t pos) {
+        vector<size_t>& positions = byCustomer[username];
+        positions.insert(lower_bound(positions.begin(), positions.end(), pos), pos);
+    }
+
+    void unindex(const string& username, size_t pos) {
+        auto found = byCustomer.find(username);
+        if (found == byCustomer.end()) return;
+        vector<size_t>& positions = found->second;
+        auto it = lower_bound(positions.begin(), positions.end(), pos);
+        if (it != positions.end() && *it == pos) positions.erase(it);
+        if (positions.empty()) byCustomer.erase(found);
+    }
+
+    void compactIfSparse() {
+        size_t empty = slots() - live;
+        if (empty <= live || empty < CHUNK_SIZE) return;
+        vector<Booking> kept(begin(), end());
+        assign(kept);
+    }
+
+public:
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+    size_t slots() const { return chunks.empty() ? 0 : (chunks.size() - 1) * CHUNK_SIZE + chunks.back()->size(); }
+    const_iterator begin() const { return const_iterator(&chunks, 0, nullptr); }
+    const_iterator end() const { return const_iterator(&chunks, chunks.size(), nullptr); }
+
+    // The booking at a position, or null if that slot is empty
+    const Booking* at(size_t pos) const {
+        if (pos >= slots()) return nullptr;
+        const optional<Booking>& slot = (*chunks[pos / CHUNK_SIZE])[pos % CHUNK_SIZE];
+        return slot ? &*slot : nullptr;
+    }
+
+    // Positions of a customer's bookings in commit order
+    const vector<size_t>& positionsOf(const string& username) const {
+        static const vector<size_t> none;
+        auto found = byCustomer.find(username);
+        return found != byCustomer.end() ? found->second : none;
+    }
+
+    // Returns the new booking's position
+    size_t push_back(const Booking& booking) {
+        if (chunks.empty() || chunks.back()->size() == CHUNK_SIZE) {
+            chunks.push_back(make_shared<BookingChunk>());
+            chunks.back()->reserve(CHUNK_SIZE);
+        }
+        size_t pos = slots();
+        writable(chunks.size() - 1).push_back(booking);
+        byCustomer[booking.getCustomerUsername()].push_back(pos);
+        live++;
+        return pos;
+    }
+
+    void replace(size_t pos, const Booking& booking) {
+        optional<Booking>& slot = writable(pos / CHUNK_SIZE)[pos % CHUNK_SIZE];
+        if (slot->getCustomerUsername() != booking.getCustomerUsername()) {
+            unindex(slot->getCustomerUsername(), pos);
+            index(booking.getCustomerUsername(), pos);
+        }
+        slot = booking;
+    }
+
+    void erase(size_t pos) {
+        optional<Booking>& slot = writable(pos / CHUNK_SIZE)[pos % CHUNK_SIZE];
+        if (!slot) return;
+        unindex(slot->getCustomerUsername(), pos);
+        slot.reset();
+        live--;
+        compactIfSparse();
+    }
+
+    // Erases every booking matching pred; chunks without one stay shared.
+    // Returns how many were erased.
+    template <class Pred>
+    size_t eraseIf(Pred pred) {
+        size_t erased = 0;
+        vector<size_t> matched;
+        for (size_t c = 0; c < chunks.size(); c++) {
+            const BookingChunk& chunk = *chunks[c];
+            matched.clear();
+            for (size_t slot = 0; slot < chunk.size(); slot++) {
+                if (chunk[slot] && pred(*chunk[slot])) matched.push_back(slot);
+            }
+            if (matched.empty()) continue;
+            BookingChunk& changed = writable(c);
+            for (size_t slot : matched) {
+                unindex(changed[slot]->getCustomerUsername(), c * CHUNK_SIZE + slot);
+                changed[slot].reset();
+            }
+            erased += matched.size();
+        }
+        live -= erased;
+        if (erased > 0) compactIfSparse();
+        return erased;
+    }
+
+    // Replaces the contents with all, in order. The chunks and the customer
+    // index are built on up to `threads` threads, one chunk per job; each
+    // job indexes its own chunk and the per-chunk indexes are then merged in
+    // chunk order, which keeps every customer's positions ascending.
+    void assign(const vector<Booking>& all, size_t threads = 1) {
+        clear();
+        size_t count = (all.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        chunks.resize(count);
+        vector<map<string, vector<size_t>>> partial(count);
+        JournalReplayer::runPool(count, threads, [&](size_t c) {
+            size_t first = c * CHUNK_SIZE;
+            size_t last = min(all.size(), first + CHUNK_SIZE);
+            auto chunk = make_shared<BookingChunk>();
+            chunk->reserve(CHUNK_SIZE);
+            for (size_t pos = first; pos < last; pos++) {
+                chunk->push_back(all[pos]);
+                partial[c][all[pos].getCustomerUsername()].push_back(pos);
+            }
+            chunks[c] = chunk;
+        });
+        for (auto& chunkIndex : partial) {
+            for (auto& customer : chunkIndex) {
+                vector<size_t>& positions = byCustomer[customer.first];
+                positions.insert(positions.end(), customer.second.begin(), customer.second.end());
+            }
+        }
+        live = all.size();
+    }
+
+    void clear() {
+        chunks.clear();
+        byCustomer.clear();
+        live = 0;
+    }
+
+    BookingList share(const set<int>& hidden) const {
+        return BookingList(vector<shared_ptr<const BookingChunk>>(chunks.begin(), chunks.end()), hidden);
+    }
+};
+
+// Point-in-time view of the booking state. Reports iterate a snapshot instead
+// of the live state, so they never see a half-applied change and never hold
+// the state lock while they run. Snapshots share the booking chunks and, until
+// the catalog changes, the movie list; a snapshot is freed when its last
+// reader releases it.
+struct BookingSnapshot {
+    unsigned long long version;
+    shared_ptr<const vector<Movie>> movieList;
+    const vector<Movie>& movies;
+    BookingList bookings;
+
+    BookingSnapshot(unsigned long long version, shared_ptr<const vector<Movie>> movieList, BookingList bookings)
+        : version(version), movieList(movieList), movies(*movieList), bookings(std::move(bookings)) {}
+};
+
+// Wire protocol between the booking server and its clients. Every frame is
+//
+//   u32 length (of what follows), u32 requestID, u8 opcode or status, body
+//
+// little-endian, with strings as u16 length + bytes and prices in centavos.
+// Bookings travel with the ID the client allocated for them.
+// Requests may be pipelined; responses come back in request order and echo
+// the requestID.
+enum WireOp : uint8_t { OP_PING = 1, OP_SEATS_LEFT = 2, OP_BOOK = 3, OP_CANCEL = 4, OP_CHANGE = 5, OP_STATS = 6 };
+enum WireStatus : uint8_t { WIRE_OK = 0, WIRE_CONFLICT = 1, WIRE_BAD_REQUEST = 2, WIRE_UNKNOWN_OP = 3 };
+const size_t WIRE_MAX_FRAME = 1 << 16;
+
+class WireWriter {
+private:
+    string buffer;
+
+public:
+    void putU8(uint8_t value) { buffer += static_cast<char>(value); }
+    void putU32(uint32_t value) {
+        for (int i = 0; i < 4; i++) buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    void putU64(uint64_t value) {
+        for (int i = 0; i < 8; i++) buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    void putString(const string& value) {
+        size_t length = min<size_t>(value.size(), 0xFFFF);
+        buffer += static_cast<char>(length & 0xFF);
+        buffer += static_cast<char>(length >> 8);
+        buffer.append(value, 0, length);
+    }
+    // Longer payloads (replication batches): u32 length + bytes
+    void putBytes(const string& value) {
+        putU32(value.size());
+        buffer += value;
+    }
+    void putBooking(const Booking& booking) {
+        putU32(booking.getBookingID());
+        putString(booking.getCustomerUsername());
+        putU32(booking.getMovieID());
+        putString(booking.getSchedule().getDate());
+        putString(booking.getSchedule().getTime());
+        putString(booking.getSeat());
+        putU64(static_cast<uint64_t>(llround(booking.getPrice() * 100)));
+        putString(booking.getPaymentMode());
+    }
+
+    const string& body() const { return buffer; }
+
+    // Wraps the body in a frame header
+    string frame(uint32_t requestID, uint8_t code) const {
+        WireWriter header;
+        header.putU32(buffer.size() + 5);
+        header.putU32(requestID);
+        header.putU8(code);
+        return header.buffer + buffer;
+    }
+};
+
+// Reads a frame body; throws out_of_range if the body is too short
+class WireReader {
+private:
+    const string& data;
+    size_t pos;
+
+    void need(size_t bytes) const {
+        if (pos + bytes > data.size()) throw out_of_range("frame");
+    }
+
+public:
+    WireReader(const string& frameData, size_t start) : data(frameData), pos(start) {}
+
+    uint8_t getU8() {
+        need(1);
+        return static_cast<uint8_t>(data[pos++]);
+    }
+    uint32_t getU32() {
+        need(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos++])) << (8 * i);
+        return value;
+    }
+    uint64_t getU64() {
+        need(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos++])) << (8 * i);
+        return value;
+    }
+    string getString() {
+        need(2);
+        size_t length = static_cast<uint8_t>(data[pos]) | (static_cast<uint8_t>(data[pos + 1]) << 8);
+        pos += 2;
+        need(length);
+        string value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+    string getBytes() {
+        size_t length = getU32();
+        need(length);
+        string value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+    Booking getBooking() {
+        int bookingID = getU32();
+        string username = getString();
+        int movieID = getU32();
+        string date = getString();
+        string time = getString();
+        string seat = getString();
+        double price = getU64() / 100.0;
+        string paymentMode = getString();
+        return Booking(bookingID, username, movieID, Schedule(date, time), seat, price, paymentMode);
+    }
+};
+
+// Splits complete frames off the front of a receive buffer. Returns false
+// while the next frame is incomplete; throws length_error on oversize frames.
+inline bool takeFrame(string& buffer, string& frame) {
+    if (buffer.size() < 4) return false;
+    uint32_t length = WireReader(buffer, 0).getU32();
+    if (length < 5 || length > WIRE_MAX_FRAME) throw length_error("frame");
+    if (buffer.size() < 4 + length) return false;
+    frame = buffer.substr(4, length);
+    buffer.erase(0, 4 + length);
+    return true;
+}
+
+// Blocking stream connection to a Unix socket; -1 if nobody listens there
+inline int connectUnixSocket(const string& path) {
+#ifdef __linux__
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+    if (fd >= 0) close(fd);
+#else
+    (void)path;
+#endif
+    return -1;
+}
+
+// Non-blocking listening socket at path, replacing a stale socket file
+inline int listenUnixSocket(const string& path) {
+#ifdef __linux__
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && listen(fd, 128) == 0) {
+        return fd;
+    }
+    if (fd >= 0) close(fd);
+#else
+    (void)path;
+#endif
+    return -1;
+}
+
+inline bool sendAll(int fd, const string& data) {
+#ifdef __linux__
+    for (size_t sent = 0; sent < data.size();) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+#else
+    (void)fd;
+    (void)data;
+    return false;
+#endif
+}
+
+// Blocking connection from a front-end to the booking server. Booking
+// commits go through it; everything else the front-end reads from the data
+// files as before.
+class BookingClient {
+private:
+    int fd = -1;
+    uint32_t nextRequestID = 1;
+    string pending;
+
+public:
+    BookingClient() = default;
+    BookingClient(const BookingClient&) = delete;
+    BookingClient& operator=(const BookingClient&) = delete;
+
+    ~BookingClient() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool connectTo(const string& path) {
+        fd = connectUnixSocket(path);
+        return fd >= 0;
+    }
+
+    // Sends one request and waits for its response. Returns WIRE_BAD_REQUEST
+    // if the connection is gone.
+    uint8_t call(uint8_t op, const WireWriter& request, string& response) {
+#ifdef __linux__
+        if (fd < 0) return WIRE_BAD_REQUEST;
+        uint32_t requestID = nextRequestID++;
+        if (!sendAll(fd, request.frame(requestID, op))) return WIRE_BAD_REQUEST;
+        try {
+            string frame;
+            while (!takeFrame(pending, frame)) {
+                char buffer[4096];
+                ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) return WIRE_BAD_REQUEST;
+                pending.append(buffer, n);
+            }
+            WireReader reader(frame, 0);
+            if (reader.getU32() != requestID) return WIRE_BAD_REQUEST;
+            uint8_t status = reader.getU8();
+            response = frame.substr(5);
+            return status;
+        } catch (...) {
+            return WIRE_BAD_REQUEST;
+        }
+#else
+        (void)op;
+        (void)request;
+        (void)response;
+        return WIRE_BAD_REQUEST;
+#endif
+    }
+
+    bool book(const Booking& booking) {
+        WireWriter request;
+        request.putBooking(booking);
+        string response;
+        return call(OP_BOOK, request, response) == WIRE_OK;
+    }
+
+    bool cancel(const Booking& ticket) {
+        WireWriter request;
+        request.putBooking(ticket);
+        string response;
+        return call(OP_CANCEL, request, response) == WIRE_OK;
+    }
+
+    bool change(const Booking& ticket, const Booking& replacement) {
+        WireWriter request;
+        request.putBooking(ticket);
+        request.putBooking(replacement);
+        string response;
+        return call(OP_CHANGE, request, response) == WIRE_OK;
+    }
+};
+
+// Replication frames, in the wire framing above with requestID 0. The primary
+// sends RESET,<generation> and the catalog files (FILE frames of at most
+// REPL_CHUNK bytes: name, u8 last, bytes) whenever the journal starts a new
+// generation, then the journal itself as RECORDS batches (u64 bytes shipped so
+// far, u64 send time in microseconds, complete journal lines). A batch with a
+// CATALOG record is followed by the catalog files again. BYE ends a
+// clean shutdown. The standby answers each batch with ACK (u64 bytes applied,
+// u64 lag of that batch in microseconds).
+enum ReplicationOp : uint8_t { REPL_RESET = 10, REPL_FILE = 11, REPL_RECORDS = 12, REPL_BYE = 13, REPL_ACK = 14 };
+const size_t REPL_CHUNK = 48 * 1024;
+const string REPLICATED_FILES[] = {"users.txt", "movies.txt", "halls.txt", "seats.txt", RETIRED_FILE};
+
+inline uint64_t wallClockMicros() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Ships the journal to a standby process (--standby) over a Unix socket.
+// Enabled by setting CINEMA_STANDBY to the standby's socket path. A thread
+// of its own tails JOURNAL_FILE every few milliseconds and sends whatever
+// was appended as one batch, so commits never wait for the standby. Each
+// generation starts with a checkpoint of every booking, so a RESET plus the
+// generation's records is a complete replica.
+class LogShipper {
+public:
+    struct Status {
+        bool connected = false;
+        string generation;
+        uint64_t shippedBytes = 0; // journal bytes sent since startup
+        uint64_t ackedBytes = 0;   // ...and applied by the standby
+        uint64_t lagMicros = 0;    // commit-to-apply delay of the last acknowledged batch
+        uint64_t batches = 0;
+    };
+
+    explicit LogShipper(const string& standbyPath) : path(standbyPath), worker([this] { run(); }) {}
+
+    ~LogShipper() {
+        stopping = true;
+        worker.join();
+    }
+
+    const string& standbyPath() const { return path; }
+
+    Status status() const {
+        lock_guard<mutex> guard(statusMutex);
+        return current;
+    }
+
+private:
+    string path;
+    mutable mutex statusMutex;
+    Status current;
+    atomic<bool> stopping{false};
+    int fd = -1;
+    string generation;     // generation being shipped; empty sends a RESET first
+    streamoff offset = 0;  // next journal byte to ship
+    string acks;           // unread part of the standby's ACK stream
+    thread worker;         // last, so it starts after everything above
+
+    void run() {
+#ifdef __linux__
+        auto lastAttempt = chrono::steady_clock::now() - chrono::seconds(1);
+        while (true) {
+            bool finalPass = stopping; // ships what the last save wrote, then says goodbye
+            if (fd < 0 && chrono::steady_clock::now() - lastAttempt >= chrono::milliseconds(500)) {
+                lastAttempt = chrono::steady_clock::now();
+                connectStandby();
+            }
+            if (fd >= 0 && !(shipPending() && readAcks())) disconnect();
+            if (finalPass) break;
+            this_thread::sleep_for(chrono::milliseconds(20));
+        }
+        if (fd >= 0) {
+            sendAll(fd, WireWriter().frame(0, REPL_BYE));
+            close(fd);
+        }
+#endif
+    }
+
+#ifdef __linux__
+    void connectStandby() {
+        fd = connectUnixSocket(path);
+        if (fd < 0) return;
+        generation.clear();
+        lock_guard<mutex> guard(statusMutex);
+        current.connected = true;
+    }
+
+    void disconnect() {
+        close(fd);
+        fd = -1;
+        acks.clear();
+        lock_guard<mutex> guard(statusMutex);
+        current.connected = false;
+    }
+
+    static string journalHeader() {
+        ifstream journal(JOURNAL_FILE, ios::binary);
+        string header;
+        if (!journal.is_open() || !getline(journal, header) || header.rfind("#JOURNAL,", 0) != 0) return "";
+        return header;
+    }
+
+    // Sends the journal appended since the last pass. Returns false if the
+    // standby went away.
+    bool shipPending() {
+        string header = journalHeader();
+        if (header.empty()) return true; // nothing committed yet
+        if (header.substr(9) != generation) {
+            if (!sendReset()) return false;
+            header = "#JOURNAL," + generation;
+        }
+
+        string pending = readPending();
+        // A CATALOG entry means the files changed outside the journal; they
+        // follow the records, read together with them under DataLock so they
+        // hold nothing older than the last record
+        vector<string> catalog;
+        if (hasCatalogEntry(pending)) {
+            DataLock::Guard guard;
+            pending = readPending();
+            catalog = readFiles(REPLICATED_FILES);
+        }
+        // A restart may have replaced the file between the two reads
+        if (journalHeader() != header) {
+            generation.clear();
+            return true;
+        }
+        if (pending.empty()) return true;
+
+        uint64_t shipped;
+        {
+            lock_guard<mutex> guard(statusMutex);
+            shipped = current.shippedBytes;
+        }
+        for (size_t start = 0; start < pending.size();) {
+            size_t end = pending.size();
+            if (end - start > REPL_CHUNK) {
+                end = pending.rfind('\n', start + REPL_CHUNK);
+                end = end == string::npos || end < start ? pending.find('\n', start) + 1 : end + 1;
+            }
+            shipped += end - start;
+            WireWriter batch;
+            batch.putU64(shipped);
+            batch.putU64(wallClockMicros());
+            batch.putBytes(pending.substr(start, end - start));
+            if (!sendAll(fd, batch.frame(0, REPL_RECORDS))) return false;
+            start = end;
+            lock_guard<mutex> guard(statusMutex);
+            current.shippedBytes = shipped;
+            current.batches++;
+        }
+        offset += pending.size();
+        return catalog.empty() || sendFiles(REPLICATED_FILES, catalog);
+    }
+
+    // Complete journal lines from offset on
+    string readPending() const {
+        ifstream journal(JOURNAL_FILE, ios::binary);
+        journal.seekg(offset);
+        string pending((istreambuf_iterator<char>(journal)), istreambuf_iterator<char>());
+        size_t complete = pending.rfind('\n');
+        pending.resize(complete == string::npos ? 0 : complete + 1);
+        return pending;
+    }
+
+    static bool hasCatalogEntry(const string& records) {
+        for (size_t found = records.find(",CATALOG"); found != string::npos; found = records.find(",CATALOG", found + 1)) {
+            size_t lineStart = records.rfind('\n', found);
+            lineStart = lineStart == string::npos ? 0 : lineStart + 1;
+            size_t end = found + 8;
+            if (records.find(',', lineStart) == found && (end == records.size() || records[end] == '\n' || records[end] == ',')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <size_t N>
+    static vector<string> readFiles(const string (&names)[N]) {
+        vector<string> contents;
+        for (const auto& name : names) {
+            ifstream in(name, ios::binary);
+            contents.emplace_back(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        }
+        return contents;
+    }
+
+    template <size_t N>
+    bool sendFiles(const string (&names)[N], const vector<string>& contents) {
+        for (size_t f = 0; f < contents.size(); f++) {
+            size_t start = 0;
+            do {
+                size_t length = min(REPL_CHUNK, contents[f].size() - start);
+                WireWriter chunk;
+                chunk.putString(names[f]);
+                chunk.putU8(start + length == contents[f].size());
+                chunk.putBytes(contents[f].substr(start, length));
+                if (!sendAll(fd, chunk.frame(0, REPL_FILE))) return false;
+                start += length;
+            } while (start < contents[f].size());
+        }
+        return true;
+    }
+
+    // Starts a new generation on the standby: the catalog files as they were
+    // when the generation's checkpoint was written, read under DataLock so no
+    // commit changes them halfway
+    bool sendReset() {
+        string header;
+        vector<string> contents;
+        {
+            DataLock::Guard guard;
+            header = journalHeader();
+            contents = readFiles(REPLICATED_FILES);
+        }
+        if (header.empty()) return true;
+
+        WireWriter reset;
+        reset.putString(header.substr(9));
+        if (!sendAll(fd, reset.frame(0, REPL_RESET))) return false;
+        if (!sendFiles(REPLICATED_FILES, contents)) return false;
+        generation = header.substr(9);
+        offset = header.size() + 1;
+        lock_guard<mutex> guard(statusMutex);
+        current.generation = generation;
+        return true;
+    }
+
+    bool readAcks() {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) acks.append(buffer, n);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+        try {
+            string frame;
+            while (takeFrame(acks, frame)) {
+                WireReader ack(frame, 4);
+                if (ack.getU8() != REPL_ACK) continue;
+                uint64_t applied = ack.getU64();
+                uint64_t lag = ack.getU64();
+                lock_guard<mutex> guard(statusMutex);
+                current.ackedBytes = applied;
+                current.lagMicros = lag;
+            }
+        } catch (...) {
+            return false;
+        }
+        return true;
+    }
+#endif
+};
+
+class CinemaBookingSystem {
+private:
+    static CinemaBookingSystem* instance;
+    vector<unique_ptr<User>> users;
+    vector<Movie> movies;
+    BookingStore bookings;
+    map<string, HallLayout> halls;                // hall name -> layout
+
+    // Where a showtime's lines sit in seats.txt while its seat map is not resident
+    struct SeatBlock {
+        vector<pair<streamoff, streamoff>> ranges; // [begin, end) byte offsets
+        string hall;
+        bool compact = false; // one run-length record instead of one line per seat
+        int freeSeats = -1;   // as recorded in the file; -1 for the old format
+    };
+    mutable map<pair<int, string>, SeatMap> movieSeats;   // <movieID, "date time"> -> seats, resident
+    mutable map<pair<int, string>, SeatBlock> seatIndex;  // <movieID, "date time"> -> block on disk
+    // Where each resident seat map was on disk when it was paged in or last
+    // saved, so evictSeats can drop one that has not changed since
+    mutable map<pair<int, string>, SeatBlock> residentBlocks;
+    mutable map<string, vector<string>> rejectedLines;     // file -> lines that failed to parse
+
+    // Bookings are the source of truth for which seats are sold. Each showtime
+    // keeps a digest of its booked seats (count plus an order-independent sum
+    // of seat hashes), updated as bookings change. reconcileSeats compares it
+    // with the seat map of every showtime touched since the last check.
+    struct SeatDigest {
+        size_t count = 0;
+        uint64_t sum = 0;
+        bool operator==(const SeatDigest& other) const { return count == other.count && sum == other.sum; }
+    };
+    map<pair<int, string>, SeatDigest> bookingDigests;
+    mutable set<pair<int, string>> dirtyShowtimes;
+    bool digestsStale = true; // bookings were reloaded, digests not rebuilt yet
+
+    // Popularity counters for the lobby display, kept in step with every
+    // booking change like the digests. Showtimes are ranked by fill rate
+    // within their week (keyed by its Monday), movies by revenue per
+    // screening day. The rankings are redone from the counters when seat maps
+    // are loaded, since a showtime's capacity comes from its hall.
+    struct ShowtimeSales {
+        int tickets = 0;
+        long long cents = 0;
+    };
+    map<pair<int, string>, ShowtimeSales> showtimeSales;
+    map<pair<int, string>, long long> movieDayCents;      // <movieID, date> -> revenue
+    map<string, Leaderboard<pair<int, string>>> fillByWeek;
+    map<string, Leaderboard<int>> revenueByDay;
+    bool rankingsStale = true;
+
+    // Deleted movies and showtimes (tombstones). They are hidden from
+    // listings, snapshots and the engine as soon as they are deleted; their
+    // bookings, seat maps and catalog entries stay until vacuumRetired
+    // removes them in batches. RETIRED_FILE keeps the tombstones across
+    // restarts as MOVIE,<id> and SHOWTIME,<id>,<date time> lines.
+    set<int> retiredMovies;
+    set<pair<int, string>> retiredShowtimes;
+
+    // Booking commits are made durable in JOURNAL_FILE, which other instances
+    // sharing the data directory also read: "#JOURNAL,<generation>", a
+    // checkpoint of every booking, then "<pid>,<entry>" lines. Entries are
+    // ADD/DEL,<booking line>, UPD,<old booking line>,<new booking line>,
+    // USER,<user line>, RETIRE,<tombstone>, or CATALOG after the catalog files
+    // were saved. bookings.txt and seats.txt are rewritten only at a
+    // checkpoint, when the journal restarts; until then the seat maps changed
+    // since stay resident, and a load replays the journal over them.
+    JournalWatcher journalWatcher;
+    streamoff journalOffset = 0;
+    streamoff journalBaseEnd = 0; // end of the generation's checkpoint
+    string journalGeneration;
+    unsigned journalRestarts = 0;
+    int groupDepth = 0;           // open GroupCommit scopes
+    vector<string> groupEntries;  // journal entries they deferred
+    bool catalogPending = false; // movies/halls/seats changed elsewhere, not reloaded yet
+    bool unsaved = false;        // repairs made while loading, not written back yet
+
+    // Set in --client mode: booking commits are sent to the server, which
+    // journals them like any other instance
+    unique_ptr<BookingClient> remote;
+
+    // Guards every change to movies, bookings and tombstones, and snapshot
+    // creation. stateVersion changes on every write, so a cached snapshot is
+    // reused until the state actually changes; catalogVersion only when the
+    // movies or tombstones change (saveData, deletes, archiving, loads), so
+    // snapshots keep sharing one movie list across booking commits. Commits
+    // hold it only while they change memory; their files are written under
+    // DataLock alone, so a snapshot never waits for disk.
+    mutable mutex stateMutex;
+    unsigned long long stateVersion = 1;
+    unsigned long long catalogVersion = 1;
+    shared_ptr<const BookingSnapshot> cachedSnapshot;
+    shared_ptr<const vector<Movie>> snapshotMovies; // as of snapshotMoviesVersion
+    unsigned long long snapshotMoviesVersion = 0;
+
+    // Movie search index and the snapshot version it was last checked against
+    mutex indexMutex;
+    shared_ptr<const CatalogIndex> cachedIndex;
+    unsigned long long indexVersion = 0;
+
+    // Streams the journal to a standby process when CINEMA_STANDBY is set
+    unique_ptr<LogShipper> shipper;
+
+    // When runMaintenance last found no full batch of past showtimes
+    chrono::steady_clock::time_point lastArchiveCheck;
+
+    CinemaBookingSystem() {
+        DataLock::Guard guard;
+        loadData();
+        attachJournal();
+        if (const char* standby = getenv("CINEMA_STANDBY")) {
+            if (journalGeneration.empty()) appendJournal("CATALOG"); // gives the standby a checkpoint to start from
+            shipper = make_unique<LogShipper>(standby);
+        }
+    }
+
+    void initializeSeatsForMovie(int movieID, const string& showtime, const string& hallName = DEFAULT_HALL) {
+        seatIndex.erase({movieID, showtime});
+        movieSeats.erase({movieID, showtime});
+        movieSeats.emplace(make_pair(movieID, showtime), SeatMap(getHall(hallName)));
+        dirtyShowtimes.insert({movieID, showtime});
+    }
+
+    void loadData() {
+        TraceSpan span("loadData", "load");
+        bool bookingsDamaged = verifyDataFiles();
+        loadUsers();
+        loadMovies();
+        // Bookings come from the journal: the checkpoint it starts with plus
+        // every commit since. bookings.txt only matters without one.
+        size_t threads = max(1u, thread::hardware_concurrency());
+        auto started = chrono::steady_clock::now();
+        set<pair<int, string>> changed;
+        int replayed = replayJournal(threads, changed);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        int renumbered = replayed < 0 ? loadBookings() : 0;
+        observeArchivedIDs();
+        map<pair<int, string>, string> hallAssignments = loadHalls();
+        loadSeats(hallAssignments);
+        loadTombstones();
+        unsaved = !rejectedLines.empty();
+        reportRejectedLines();
+        restoreSeats(changed, threads);
+        if (bookingsDamaged && replayed >= 0) {
+            cerr << "bookings.txt: recovered " << replayed << " booking(s) from " << JOURNAL_FILE << " in "
+                 << fixed << setprecision(3) << seconds << " s on " << threads << " thread(s)." << endl;
+            saveBookings();
+        } else if (bookingsDamaged) {
+            cerr << "bookings.txt: " << JOURNAL_FILE << " has no checkpoint; damaged bookings were not recovered." << endl;
+        } else if (renumbered > 0) {
+            cerr << "bookings.txt: gave " << renumbered << " booking(s) with a duplicate ID a new one." << endl;
+            saveBookings();
+        }
+        reconcileSeats();
+        // A clean load leaves every seat map on disk; resident ones were
+        // created, migrated, repaired or changed since the checkpoint
+        unsaved = unsaved || !movieSeats.empty();
+    }
+
+    // Rebuilds the bookings from the journal: the checkpoint it starts with
+    // plus every commit after it, replayed by showtime on up to `threads`
+    // threads (see JournalReplayer). The surviving lines are parsed and
+    // stored, customer index included, on the same pool. changed receives the
+    // showtimes committed to since the checkpoint, whose seat maps in
+    // seats.txt are older than the bookings. Returns the number of bookings,
+    // or -1 if the journal has no checkpoint.
+    int replayJournal(size_t threads, set<pair<int, string>>& changed) {
+        TraceSpan span("replayJournal", "load");
+        ifstream journalFile(JOURNAL_FILE, ios::binary);
+        string journal((istreambuf_iterator<char>(journalFile)), istreambuf_iterator<char>());
+        JournalReplayer::Result replayed = JournalReplayer::replay(journal, threads);
+        if (!replayed.checkpointed) return -1;
+
+        vector<const JournalReplayer::Record*> live;
+        for (const auto& partition : replayed.live) {
+            for (const auto& record : partition.second) live.push_back(&record);
+        }
+        sort(live.begin(), live.end(), [](const JournalReplayer::Record* a, const JournalReplayer::Record* b) {
+            return a->seq < b->seq;
+        });
+
+        vector<optional<Booking>> parsed(live.size());
+        size_t blocks = (live.size() + BookingStore::CHUNK_SIZE - 1) / BookingStore::CHUNK_SIZE;
+        JournalReplayer::runPool(blocks, threads, [&](size_t block) {
+            size_t last = min(live.size(), (block + 1) * BookingStore::CHUNK_SIZE);
+            for (size_t i = block * BookingStore::CHUNK_SIZE; i < last; i++) {
+                vector<string> tokens;
+                string token;
+                istringstream tokenStream(live[i]->booking);
+                while (getline(tokenStream, token, ',')) tokens.push_back(token);
+                try {
+                    parsed[i] = bookingFromTokens(tokens, 0);
+                } catch (...) {
+                }
+            }
+        });
+        vector<Booking> recovered;
+        recovered.reserve(live.size());
+        for (size_t i = 0; i < live.size(); i++) {
+            if (!parsed[i]) {
+                rejectLine(JOURNAL_FILE, live[i]->booking);
+                continue;
+            }
+            recovered.push_back(std::move(*parsed[i]));
+            BookingIDAllocator::get().observe(recovered.back().getBookingID());
+        }
+        {
+            lock_guard<mutex> lock(stateMutex);
+            bookings.assign(recovered, threads);
+            stateVersion++;
+        }
+        digestsStale = true;
+        changed = std::move(replayed.changed);
+        return recovered.size();
+    }
+
+    // Pages in the seat maps of the given showtimes and rebuilds their booked
+    // seats from the bookings, one showtime per job. Seat maps are separate
+    // objects once resident, so each can be restored on its own thread.
+    void restoreSeats(const set<pair<int, string>>& keys, size_t threads) {
+        if (keys.empty()) return;
+        TraceSpan span("restoreSeats", "load");
+        map<pair<int, string>, vector<const Booking*>> byShowtime;
+        for (const auto& booking : bookings) {
+            pair<int, string> key(booking.getMovieID(), booking.getSchedule().getFullSchedule());
+            if (keys.count(key)) byShowtime[key].push_back(&booking);
+        }
+        vector<pair<SeatMap*, const vector<const Booking*>*>> jobs;
+        static const vector<const Booking*> none;
+        for (const auto& key : keys) {
+            SeatMap* seats = findSeats(key);
+            if (!seats) continue;
+            auto found = byShowtime.find(key);
+            jobs.push_back({seats, found != byShowtime.end() ? &found->second : &none});
+        }
+        JournalReplayer::runPool(jobs.size(), threads, [&](size_t j) { restoreFromBookings(*jobs[j].first, *jobs[j].second); });
+    }
+
+    // Checks every data file against its checksum sidecar before anything is
+    // parsed. Corrupt blocks are quarantined; seat maps lost that way are
+    // rebuilt from bookings by loadSeats.
+    // Returns true if bookings.txt was damaged
+    bool verifyDataFiles() {
+        TraceSpan span("loadData/verify", "load");
+        vector<IntegrityScanner::Result> results =
+            IntegrityScanner::scan({"users.txt", "movies.txt", "bookings.txt", "halls.txt", "seats.txt"});
+        bool bookingsDamaged = false;
+        for (const auto& result : results) {
+            if (result.badBlocks > 0) {
+                cerr << result.file << ": " << result.badBlocks << " of " << result.blocks
+                     << " block(s) failed checksum; " << result.quarantined.size() << " line(s) moved to "
+                     << result.file << ".quarantine" << endl;
+                if (result.file == "bookings.txt") bookingsDamaged = true;
+            }
+        }
+        return bookingsDamaged;
+    }
+
+    // Lines the loaders could not parse are kept aside instead of being
+    // dropped silently, then reported once per file
+    void rejectLine(const string& file, const string& line) const {
+        if (line.empty() || line == "\r") return;
+        rejectedLines[file].push_back(line);
+    }
+
+    void reportRejectedLines() const {
+        for (const auto& rejected : rejectedLines) {
+            IntegrityScanner::quarantine(rejected.first, rejected.second, "could not be parsed");
+            cerr << rejected.first << ": skipped " << rejected.second.size() << " malformed line(s), moved to "
+                 << rejected.first << ".quarantine" << endl;
+        }
+        rejectedLines.clear();
+    }
+
+    // Reads halls.txt: "HALL,name,rows,seatsPerRow,A1;A2" defines a layout and
+    // "ASSIGN,movieID,date time,name" attaches it to a showtime. Showtimes
+    // without an assignment use the standard 8x10 hall.
+    map<pair<int, string>, string> loadHalls() {
+        TraceSpan span("loadData/halls", "load");
+        halls.clear();
+        halls.emplace(DEFAULT_HALL, HallLayout(DEFAULT_HALL, 8, 10));
+
+        ifstream hallFile("halls.txt");
+        if (hallFile.is_open()) {
+            string line;
+            while (getline(hallFile, line)) {
+                vector<string> tokens;
+                string token;
+                istringstream tokenStream(line);
+                while (getline(tokenStream, token, ',')) {
+                    tokens.push_back(token);
+                }
+
+                try {
+                    if (tokens.size() >= 4 && tokens[0] == "HALL") {
+                        int rows = stoi(tokens[2]);
+                        int seatsPerRow = stoi(tokens[3]);
+                        if (rows < 1 || rows > HallLayout::MAX_ROWS || seatsPerRow < 1 || seatsPerRow > HallLayout::MAX_SEATS_PER_ROW) {
+                            throw invalid_argument("hall size");
+                        }
+                        HallLayout hall(tokens[1], rows, seatsPerRow);
+                        if (tokens.size() >= 5) {
+                            string blocked;
+                            istringstream blockedStream(tokens[4]);
+                            while (getline(blockedStream, blocked, ';')) {
+                                int index = hall.seatIndex(blocked);
+                                if (index >= 0) hall.setBlocked(index, true);
+                            }
+                        }
+                        halls.erase(hall.getName());
+                        halls.emplace(hall.getName(), hall);
+                    } else if (tokens.empty() || tokens[0] != "ASSIGN") {
+                        rejectLine("halls.txt", line);
+                    }
+                } catch (...) {
+                    rejectLine("halls.txt", line);
+                }
+            }
+            hallFile.close();
+        }
+        return readHallAssignments();
+    }
+
+    map<pair<int, string>, string> readHallAssignments() const {
+        map<pair<int, string>, string> assignments;
+        ifstream hallFile("halls.txt");
+        string line;
+        while (getline(hallFile, line)) {
+            vector<string> tokens;
+            string token;
+            istringstream tokenStream(line);
+            while (getline(tokenStream, token, ',')) {
+                tokens.push_back(token);
+            }
+            if (tokens.empty() || tokens[0] != "ASSIGN") continue;
+            try {
+                if (tokens.size() < 4) throw invalid_argument("assign");
+                assignments[{stoi(tokens[1]), tokens[2]}] = tokens[3];
+            } catch (...) {
+                rejectLine("halls.txt", line);
+            }
+        }
+        return assignments;
+    }
+
+    void loadUsers() {
+        TraceSpan span("loadData/users", "load");
+        ifstream userFile("users.txt");
+        if (userFile.is_open()) {
+            string line;
+            while (getline(userFile, line)) {
+                vector<string> tokens;
+                string token;
+                istringstream tokenStream(line);
+                while (getline(tokenStream, token, ',')) {
+                    tokens.push_back(token);
+                }
+
+                try {
+                    if (tokens.size() >= 4 && tokens[0] == "CUSTOMER") {
+                        users.push_back(make_unique<Customer>(tokens[1], tokens[2], tokens[3]));
+                    } else if (tokens.size() >= 3 && tokens[0] == "ADMIN") {
+                        users.push_back(make_unique<Admin>(tokens[1], tokens[2]));
+                    } else {
+                        rejectLine("users.txt", line);
+                    }
+                } catch (...) {
+                    rejectLine("users.txt", line);
+                }
+            }
+            userFile.close();
+        }
+    }
+
+    // Parses the eight fields of a booking line starting at tokens[first]
+    static Booking bookingFromTokens(const vector<string>& tokens, size_t first) {
+        if (tokens.size() < first + 8) throw invalid_argument("booking");
+        return Booking(
+            stoi(tokens[first]),
+            tokens[first + 1],
+            stoi(tokens[first + 2]),
+            Schedule(tokens[first + 3], tokens[first + 4]),
+            tokens[first + 5],
+            stod(tokens[first + 6]),
+            tokens[first + 7]
+        );
+    }
+
+    void loadMovies() {
+        TraceSpan span("loadData/movies", "load");
+        ifstream movieFile("movies.txt");
+        vector<Movie> loaded;
+        if (movieFile.is_open()) {
+            string line;
+            while (getline(movieFile, line)) {
+                vector<string> tokens;
+                string token;
+                istringstream tokenStream(line);
+                while (getline(tokenStream, token, ',')) {
+                    tokens.push_back(token);
+                }
+
+                if (tokens.size() >= 4) {
+                    try {
+                        double price = stod(tokens[3]);
+                        Movie movie(stoi(tokens[0]), tokens[1], tokens[2], price);
+                        for (size_t i = 4; i < tokens.size(); i += 2) {
+                            if (i + 1 < tokens.size()) {
+                                movie.addSchedule(Schedule(tokens[i], tokens[i+1]));
+                            }
+                        }
+                        loaded.push_back(movie);
+                    } catch (...) {
+                        rejectLine("movies.txt", line);
+                    }
+                } else {
+                    rejectLine("movies.txt", line);
+                }
+            }
+            movieFile.close();
+        }
+        lock_guard<mutex> lock(stateMutex);
+        movies = std::move(loaded);
+        catalogVersion = ++stateVersion;
+    }
+
+    // Returns how many bookings had to be given a new ID because another
+    // booking in the file already had theirs
+    int loadBookings() {
+        TraceSpan span("loadData/bookings", "load");
+        ifstream bookingFile("bookings.txt");
+        set<int> loadedIDs;
+        vector<size_t> duplicates;
+        vector<Booking> loaded;
+        if (bookingFile.is_open()) {
+            string line;
+            while (getline(bookingFile, line)) {
+                vector<string> tokens;
+                string token;
+                istringstream tokenStream(line);
+                while (getline(tokenStream, token, ',')) {
+                    tokens.push_back(token);
+                }
+
+                if (tokens.size() >= 8) {
+                    try {
+                        loaded.push_back(bookingFromTokens(tokens, 0));
+                        int bookingID = loaded.back().getBookingID();
+                        if (!loadedIDs.insert(bookingID).second) duplicates.push_back(loaded.size() - 1);
+                        BookingIDAllocator::get().observe(bookingID);
+                    } catch (...) {
+                        rejectLine("bookings.txt", line);
+                    }
+                } else {
+                    rejectLine("bookings.txt", line);
+                }
+            }
+            bookingFile.close();
+        }
+        for (size_t index : duplicates) {
+            loaded[index] = loaded[index].withID(BookingIDAllocator::get().next());
+        }
+        digestsStale = true;
+        lock_guard<mutex> lock(stateMutex);
+        bookings.assign(loaded);
+        stateVersion++;
+        return duplicates.size();
+    }
+
+    // seats.txt starts with SEAT_FORMAT_HEADER and holds one record per
+    // showtime: "movieID,date time,booked,removed", where booked and removed
+    // are ';'-separated seat runs like "A3;B1-B4" (or "-" for none). Removed
+    // seats are hall positions an admin took out for that showtime.
+    //
+    // Files without the header use the old format of one
+    // "movieID,showtime,seat,1|0" line per seat, where seats not listed do not
+    // exist. Those are still read and are rewritten in the new format on save.
+    //
+    // Startup only records where each showtime's lines sit in the file; the
+    // seat map itself is paged in by findSeats the first time it is used.
+    void loadSeats(const map<pair<int, string>, string>& hallAssignments) {
+        TraceSpan span("loadData/seats", "load");
+        indexSeatFile(hallAssignments, true);
+        migrateLegacySeatKeys();
+
+        // Every scheduled showtime gets a seat map, even if none was saved or
+        // its record was quarantined; reconcileSeats restores its booked seats
+        for (const auto& movie : movies) {
+            for (const auto& schedule : movie.getSchedules()) {
+                pair<int, string> key(movie.getMovieID(), schedule.getFullSchedule());
+                if (!movieSeats.count(key) && !seatIndex.count(key)) {
+                    auto assigned = hallAssignments.find(key);
+                    initializeSeatsForMovie(key.first, key.second, assigned != hallAssignments.end() ? assigned->second : DEFAULT_HALL);
+                }
+            }
+        }
+        rankingsStale = true; // showtimes may now sit in other halls
+    }
+
+    // Records where each showtime sits in seats.txt. Showtimes that are
+    // already resident are skipped, so this also re-indexes the file after
+    // another instance rewrote it.
+    void indexSeatFile(const map<pair<int, string>, string>& hallAssignments, bool initialLoad) const {
+        ifstream seatFile("seats.txt", ios::binary);
+        if (seatFile.is_open()) {
+            string line;
+            streamoff offset = 0;
+            bool compact = false;
+            while (getline(seatFile, line)) {
+                streamoff next = offset + line.size() + 1;
+                if (offset == 0 && trimmedLine(line) == SEAT_FORMAT_HEADER) {
+                    compact = true;
+                    offset = next;
+                    continue;
+                }
+                pair<int, string> key;
+                if (parseSeatKey(line, key) && isValidShowtime(key.second)) {
+                    if (movieSeats.count(key)) {
+                        offset = next;
+                        continue;
+                    }
+                    SeatBlock& block = seatIndex[key];
+                    block.compact = compact;
+                    if (compact) {
+                        auto assigned = hallAssignments.find(key);
+                        block.freeSeats = countFreeSeats(line, getHall(assigned != hallAssignments.end() ? assigned->second : DEFAULT_HALL));
+                    }
+                    if (!block.ranges.empty() && block.ranges.back().second == offset) {
+                        block.ranges.back().second = next;
+                    } else {
+                        block.ranges.push_back({offset, next});
+                    }
+                } else if (compact || !initialLoad) {
+                    if (initialLoad) rejectLine("seats.txt", line);
+                } else {
+                    // Legacy date-keyed or malformed lines are parsed right away
+                    // so migrateLegacySeatKeys can deal with them
+                    applySeatLine(line, hallAssignments);
+                }
+                offset = next;
+            }
+            seatFile.close();
+        }
+        for (auto& indexed : seatIndex) {
+            auto assigned = hallAssignments.find(indexed.first);
+            indexed.second.hall = assigned != hallAssignments.end() ? assigned->second : DEFAULT_HALL;
+        }
+    }
+
+    void reindexSeats() const {
+        TraceSpan span("reindexSeats", "sync");
+        seatIndex.clear();
+        indexSeatFile(readHallAssignments(), false);
+    }
+
+    // Reads the "movieID,showtime" prefix of a seats.txt line
+    static bool parseSeatKey(const string& line, pair<int, string>& key) {
+        size_t first = line.find(',');
+        size_t second = first == string::npos ? string::npos : line.find(',', first + 1);
+        if (second == string::npos) return false;
+        try {
+            key = {stoi(line.substr(0, first)), line.substr(first + 1, second - first - 1)};
+        } catch (...) {
+            return false;
+        }
+        return true;
+    }
+
+    static string trimmedLine(string line) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return line;
+    }
+
+    // Encodes the positions for which test(index) holds as runs of seat labels
+    template <typename Test>
+    static string encodeSeatRuns(const HallLayout& hall, Test test) {
+        string runs;
+        int positions = hall.positions();
+        for (int i = 0; i < positions; i++) {
+            if (!test(i)) continue;
+            int end = i;
+            while (end + 1 < positions && test(end + 1)) end++;
+            if (!runs.empty()) runs += ';';
+            runs += hall.seatLabel(i);
+            if (end > i) runs += "-" + hall.seatLabel(end);
+            i = end;
+        }
+        return runs.empty() ? "-" : runs;
+    }
+
+    static bool decodeSeatRuns(const HallLayout& hall, const string& runs, vector<int>& positions) {
+        if (runs == "-") return true;
+        string run;
+        istringstream runStream(runs);
+        while (getline(runStream, run, ';')) {
+            size_t dash = run.find('-');
+            int first = hall.seatIndex(run.substr(0, dash));
+            int last = dash == string::npos ? first : hall.seatIndex(run.substr(dash + 1));
+            if (first < 0 || last < first) return false;
+            for (int i = first; i <= last; i++) positions.push_back(i);
+        }
+        return true;
+    }
+
+    static string encodeSeatRecord(const pair<int, string>& key, const SeatMap& seats) {
+        const HallLayout& hall = seats.getLayout();
+        return to_string(key.first) + "," + key.second + "," +
+               encodeSeatRuns(hall, [&](int i) { return seats.isBooked(i); }) + "," +
+               encodeSeatRuns(hall, [&](int i) { return !hall.isBlocked(i) && !seats.hasSeat(i); });
+    }
+
+    // Free seats of a compact record, counted without building its seat map;
+    // -1 if the record does not parse
+    static int countFreeSeats(const string& line, const HallLayout& hall) {
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(trimmedLine(line));
+        while (getline(tokenStream, token, ',')) {
+            tokens.push_back(token);
+        }
+        vector<int> booked, removed;
+        if (tokens.size() < 4 || !decodeSeatRuns(hall, tokens[2], booked) || !decodeSeatRuns(hall, tokens[3], removed)) {
+            return -1;
+        }
+        return max(0, hall.capacity() - static_cast<int>(booked.size() + removed.size()));
+    }
+
+    // Applies one compact "movieID,showtime,booked,removed" record
+    void applySeatRecord(const string& line, const HallLayout& hall) const {
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(trimmedLine(line));
+        while (getline(tokenStream, token, ',')) {
+            tokens.push_back(token);
+        }
+
+        vector<int> booked, removed;
+        try {
+            if (tokens.size() < 4 || !decodeSeatRuns(hall, tokens[2], booked) || !decodeSeatRuns(hall, tokens[3], removed)) {
+                throw invalid_argument("record");
+            }
+            SeatMap seats(hall);
+            for (int index : removed) seats.closeSeat(index);
+            for (int index : booked) seats.book(index);
+            pair<int, string> key(stoi(tokens[0]), tokens[1]);
+            movieSeats.erase(key);
+            movieSeats.emplace(key, seats);
+        } catch (...) {
+            rejectLine("seats.txt", line);
+        }
+    }
+
+    // Applies one "movieID,showtime,seat,available" line to the resident seat maps
+    void applySeatLine(const string& line, const map<pair<int, string>, string>& hallAssignments) const {
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(line);
+        while (getline(tokenStream, token, ',')) {
+            tokens.push_back(token);
+        }
+        if (!tokens.empty() && !tokens.back().empty() && tokens.back().back() == '\r') tokens.back().pop_back();
+
+        if (tokens.size() >= 4) {
+            try {
+                pair<int, string> key(stoi(tokens[0]), tokens[1]);
+                string seat = tokens[2];
+                bool available = (tokens[3] == "1");
+                auto it = movieSeats.find(key);
+                if (it == movieSeats.end()) {
+                    auto assigned = hallAssignments.find(key);
+                    const HallLayout& hall = getHall(assigned != hallAssignments.end() ? assigned->second : DEFAULT_HALL);
+                    it = movieSeats.emplace(key, SeatMap(hall, false)).first;
+                }
+                int index = it->second.indexOf(seat);
+                if (index < 0) throw invalid_argument("seat");
+                it->second.openSeat(index);
+                if (!available) it->second.book(index);
+            } catch (...) {
+                rejectLine("seats.txt", line);
+            }
+        } else {
+            rejectLine("seats.txt", line);
+        }
+    }
+
+    // Returns the seat map of a showtime, paging it in from seats.txt if it is
+    // not resident yet. Returns nullptr if the showtime has no seat data.
+    SeatMap* findSeats(const pair<int, string>& key) const {
+        auto it = movieSeats.find(key);
+        if (it != movieSeats.end()) return &it->second;
+        if (!seatIndex.count(key)) return nullptr;
+
+        TraceSpan span("pageInSeats", "load");
+        DataLock::Guard guard;
+        pair<int, string> wanted = key; // key may refer to the index entry erased below
+        vector<string> lines;
+        if (!readSeatBlock(wanted, lines)) {
+            // seats.txt was rewritten by another instance since it was indexed
+            reindexSeats();
+            if (!seatIndex.count(wanted) || !readSeatBlock(wanted, lines)) return nullptr;
+        }
+
+        const SeatBlock& block = seatIndex.at(wanted);
+        map<pair<int, string>, string> assignment = {{wanted, block.hall}};
+        for (const auto& line : lines) {
+            if (block.compact) applySeatRecord(line, getHall(block.hall));
+            else applySeatLine(line, assignment);
+        }
+        dirtyShowtimes.insert(wanted);
+        it = movieSeats.find(wanted);
+        if (it == movieSeats.end()) {
+            it = movieSeats.emplace(wanted, SeatMap(getHall(block.hall))).first;
+        }
+        residentBlocks[wanted] = block;
+        seatIndex.erase(wanted);
+        return &it->second;
+    }
+
+    // Reads the indexed lines of a showtime; false if any of them belongs to
+    // another showtime, i.e. the offsets are stale
+    bool readSeatBlock(const pair<int, string>& key, vector<string>& lines) const {
+        lines.clear();
+        ifstream seatFile("seats.txt", ios::binary);
+        for (const auto& range : seatIndex.at(key).ranges) {
+            string buffer(range.second - range.first, '\0');
+            seatFile.clear();
+            seatFile.seekg(range.first);
+            seatFile.read(&buffer[0], buffer.size());
+            buffer.resize(seatFile.gcount());
+            istringstream blockLines(buffer);
+            string line;
+            while (getline(blockLines, line)) {
+                pair<int, string> lineKey;
+                if (!parseSeatKey(line, lineKey) || lineKey != key) return false;
+                lines.push_back(line);
+            }
+        }
+        return !lines.empty();
+    }
+
+    // Pages in every indexed showtime, for reports that need the whole
+    // history. Returns the showtimes it paged in; pass them to evictSeats
+    // when done so they do not stay resident.
+    vector<pair<int, string>> loadAllSeats() const {
+        vector<pair<int, string>> paged;
+        while (!seatIndex.empty()) {
+            paged.push_back(seatIndex.begin()->first);
+            findSeats(paged.back());
+        }
+        return paged;
+    }
+
+    // Pages the given showtimes out again if their seat maps still match
+    // their record on disk; changed ones stay resident until the next save
+    void evictSeats(const vector<pair<int, string>>& keys) const {
+        DataLock::Guard guard;
+        ifstream seatFile("seats.txt", ios::binary);
+        for (const auto& key : keys) {
+            auto resident = movieSeats.find(key);
+            auto block = residentBlocks.find(key);
+            if (resident == movieSeats.end() || block == residentBlocks.end() || !block->second.compact ||
+                block->second.ranges.size() != 1) {
+                continue;
+            }
+            const pair<streamoff, streamoff>& range = block->second.ranges[0];
+            string onDisk(range.second - range.first, '\0');
+            seatFile.clear();
+            seatFile.seekg(range.first);
+            seatFile.read(&onDisk[0], onDisk.size());
+            if (seatFile.gcount() != static_cast<streamsize>(onDisk.size()) ||
+                onDisk != encodeSeatRecord(key, resident->second) + '\n') {
+                continue;
+            }
+            seatIndex[key] = block->second;
+            movieSeats.erase(resident);
+            residentBlocks.erase(block);
+        }
+    }
+
+    // Older seats.txt files keyed seat maps by date only, so every showtime of
+    // a movie on that date shared one map. Give each showtime on that date its
+    // own copy and drop keys that match no scheduled showtime.
+    void migrateLegacySeatKeys() {
+        int migrated = 0, dropped = 0;
+        for (auto it = movieSeats.begin(); it != movieSeats.end();) {
+            if (isValidShowtime(it->first.second)) {
+                ++it;
+                continue;
+            }
+            bool matched = false;
+            if (isValidDate(it->first.second)) {
+                for (const auto& movie : movies) {
+                    if (movie.getMovieID() != it->first.first) continue;
+                    for (const auto& schedule : movie.getSchedules()) {
+                        pair<int, string> showtimeKey(movie.getMovieID(), schedule.getFullSchedule());
+                        if (schedule.getDate() == it->first.second && !seatIndex.count(showtimeKey)) {
+                            movieSeats.emplace(showtimeKey, it->second);
+                            matched = true;
+                        }
+                    }
+                }
+            }
+            (matched ? migrated : dropped)++;
+            it = movieSeats.erase(it);
+        }
+        if (migrated > 0 || dropped > 0) {
+            cerr << "Migrated " << migrated << " date-keyed seat map(s) to per-showtime seat maps; dropped "
+                 << dropped << " with no matching showtime." << endl;
+        }
+    }
+
+    // Journal position at startup: everything in it is already in the files
+    void attachJournal() {
+        ifstream journal(JOURNAL_FILE, ios::binary);
+        string header;
+        if (journal.is_open() && getline(journal, header) && header.rfind("#JOURNAL,", 0) == 0) {
+            journalGeneration = header.substr(9);
+            string line;
+            while (getline(journal, line)) {
+                if (line.find(",CHECKPOINT,") != string::npos) {
+                    journalBaseEnd = journal.tellg();
+                    break;
+                }
+            }
+            journal.clear();
+            journal.seekg(0, ios::end);
+            journalOffset = journal.tellg();
+        }
+        journalWatcher.changed();
+    }
+
+    // Commits under DataLock: the entries are on disk when this returns.
+    // Once the changes since the checkpoint pass JOURNAL_COMPACT_BYTES, the
+    // commit takes a checkpoint instead: bookings.txt and seats.txt are
+    // rewritten, then the journal restarts under a new generation that
+    // begins with every booking (see JournalReplayer) and these entries.
+    // Instances that see the new generation replay it. It is written beside
+    // the old journal and renamed over it, so a crash leaves one or the
+    // other, and either replays to the same bookings over the new files.
+    void appendJournal(const string& entry) { appendJournal(vector<string>{entry}); }
+
+    // Appends the entries of one commit with a single write; inside a
+    // GroupCommit they wait for the group's write instead
+    void appendJournal(const vector<string>& entries) {
+        if (entries.empty()) return;
+        if (groupDepth > 0) {
+            groupEntries.insert(groupEntries.end(), entries.begin(), entries.end());
+            return;
+        }
+        bool restart = journalGeneration.empty() || journalOffset - journalBaseEnd > JOURNAL_COMPACT_BYTES;
+        if (restart) {
+            saveBookingData();
+            restartJournal(entries);
+            return;
+        }
+        {
+            ofstream journal(JOURNAL_FILE, ios::binary | ios::app);
+            if (!journal.is_open()) return;
+            for (const auto& entry : entries) journal << processID() << "," << entry << '\n';
+            journal.flush();
+            journalOffset = journal.tellp();
+        }
+        syncPath(JOURNAL_FILE);
+    }
+
+    void restartJournal(const vector<string>& entries) {
+        // Unique even for several restarts within one second
+        string generation = to_string(time(nullptr)) + "." + to_string(processID()) + "." + to_string(++journalRestarts);
+        streamoff baseEnd, end;
+        {
+            ofstream journal(JOURNAL_FILE + ".tmp", ios::binary | ios::trunc);
+            if (!journal.is_open()) return;
+            journal << "#JOURNAL," << generation << '\n';
+            for (const auto& booking : bookings) journal << processID() << ",BASE," << bookingLine(booking) << '\n';
+            journal << processID() << ",CHECKPOINT," << bookings.size() << '\n';
+            baseEnd = journal.tellp();
+            for (const auto& entry : entries) journal << processID() << "," << entry << '\n';
+            end = journal.tellp();
+            if (!journal.flush()) return;
+        }
+        if (!replaceFile(JOURNAL_FILE + ".tmp", JOURNAL_FILE)) return;
+        journalGeneration = generation;
+        journalBaseEnd = baseEnd;
+        journalOffset = end;
+    }
+
+    static string bookingLine(const Booking& booking) {
+        ostringstream out;
+        writeBookingLine(out, booking);
+        string line = out.str();
+        if (!line.empty() && line.back() == '\n') line.pop_back();
+        return line;
+    }
+
+    static bool sameTicket(const Booking& a, const Booking& b) {
+        return a.getMovieID() == b.getMovieID() && a.getSeat() == b.getSeat() &&
+               a.getCustomerUsername() == b.getCustomerUsername() &&
+               a.getSchedule().getFullSchedule() == b.getSchedule().getFullSchedule();
+    }
+
+    int findBooking(const Booking& ticket) const {
+        for (size_t pos : bookings.positionsOf(ticket.getCustomerUsername())) {
+            if (sameTicket(*bookings.at(pos), ticket)) return pos;
+        }
+        return -1;
+    }
+
+    // Applies another instance's entry. Booking entries are idempotent, as
+    // after a checkpoint the journal may be replayed over bookings that
+    // already hold some of them. Seat maps are paged in to take the change,
+    // since seats.txt has it only after the next checkpoint.
+    void applyJournalEntry(const vector<string>& tokens) {
+        const string& op = tokens[1];
+        lock_guard<mutex> lock(stateMutex);
+        if (op == "ADD") {
+            Booking booking = bookingFromTokens(tokens, 2);
+            if (findBooking(booking) >= 0) return;
+            bookings.push_back(booking);
+            noteBooking(booking, true);
+            bookSeat(booking.getMovieID(), booking.getSchedule().getFullSchedule(), booking.getSeat());
+            stateVersion++;
+        } else if (op == "DEL" || op == "UPD") {
+            int index = findBooking(bookingFromTokens(tokens, 2));
+            optional<Booking> after;
+            if (op == "UPD") after = bookingFromTokens(tokens, 10);
+            int present = after ? findBooking(*after) : -1;
+            bool adding = after && (present < 0 || present == index);
+            if (index < 0 && !adding) return;
+            if (index >= 0) {
+                Booking before = *bookings.at(index);
+                noteBooking(before, false);
+                freeSeat(before.getMovieID(), before.getSchedule().getFullSchedule(), before.getSeat());
+            }
+            if (adding) {
+                if (index >= 0) bookings.replace(index, *after);
+                else bookings.push_back(*after);
+                noteBooking(*after, true);
+                bookSeat(after->getMovieID(), after->getSchedule().getFullSchedule(), after->getSeat());
+            } else {
+                bookings.erase(index);
+            }
+            stateVersion++;
+        } else if (op == "USER") {
+            addUserIfMissing(tokens, 2);
+        } else if (op == "RETIRE") {
+            applyTombstone(tokens, 2);
+            catalogVersion = ++stateVersion;
+        }
+    }
+
+    // Records one tombstone (tokens[first] onwards). A deleted showtime
+    // leaves its movie's schedule list right away; that list is short.
+    void applyTombstone(const vector<string>& tokens, size_t first) {
+        if (tokens.size() < first + 2) throw invalid_argument("tombstone");
+        int movieID = stoi(tokens[first + 1]);
+        if (tokens[first] == "MOVIE") {
+            retiredMovies.insert(movieID);
+            return;
+        }
+        if (tokens[first] != "SHOWTIME" || tokens.size() < first + 3) throw invalid_argument("tombstone");
+        const string& showtime = tokens[first + 2];
+        retiredShowtimes.insert({movieID, showtime});
+        for (auto& movie : movies) {
+            if (movie.getMovieID() != movieID) continue;
+            const vector<Schedule>& schedules = movie.getSchedules();
+            for (size_t i = 0; i < schedules.size(); i++) {
+                if (schedules[i].getFullSchedule() == showtime) {
+                    movie.removeSchedule(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    void loadTombstones() {
+        lock_guard<mutex> lock(stateMutex);
+        catalogVersion = ++stateVersion;
+        retiredMovies.clear();
+        retiredShowtimes.clear();
+        ifstream retiredFile(RETIRED_FILE);
+        string line;
+        while (getline(retiredFile, line)) {
+            vector<string> tokens;
+            string token;
+            istringstream tokenStream(line);
+            while (getline(tokenStream, token, ',')) {
+                tokens.push_back(token);
+            }
+            try {
+                applyTombstone(tokens, 0);
+            } catch (...) {
+                rejectLine(RETIRED_FILE, line);
+            }
+        }
+    }
+
+    void saveTombstones() {
+        if (retiredMovies.empty() && retiredShowtimes.empty()) {
+            remove(RETIRED_FILE.c_str());
+            return;
+        }
+        ostringstream retiredFile;
+        for (int movieID : retiredMovies) retiredFile << "MOVIE," << movieID << '\n';
+        for (const auto& key : retiredShowtimes) retiredFile << "SHOWTIME," << key.first << "," << key.second << '\n';
+        writeWholeFile(RETIRED_FILE, retiredFile.str());
+    }
+
+    // Commits one tombstone: an append to RETIRED_FILE and the journal,
+    // nothing else is rewritten
+    void retire(const vector<string>& tombstone) {
+        DataLock::Guard guard;
+        syncFromJournal(false);
+        {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            applyTombstone(tombstone, 0);
+        }
+        string line;
+        for (const auto& field : tombstone) line += (line.empty() ? "" : ",") + field;
+        ofstream(RETIRED_FILE, ios::app) << line << '\n';
+        appendJournal("RETIRE," + line);
+    }
+
+    // Forgets every seat map and digest of a movie, including showtimes no
+    // longer on its schedule
+    void dropShowtimesOf(int movieID) {
+        auto inMovie = [movieID](const auto& entry) { return entry.first.first == movieID; };
+        pair<int, string> first(movieID, "");
+        for (auto it = movieSeats.lower_bound(first); it != movieSeats.end() && inMovie(*it);) it = movieSeats.erase(it);
+        for (auto it = seatIndex.lower_bound(first); it != seatIndex.end() && inMovie(*it);) it = seatIndex.erase(it);
+        for (auto it = bookingDigests.lower_bound(first); it != bookingDigests.end() && inMovie(*it);) {
+            it = bookingDigests.erase(it);
+        }
+        for (auto it = dirtyShowtimes.lower_bound(first); it != dirtyShowtimes.end() && it->first == movieID;) {
+            it = dirtyShowtimes.erase(it);
+        }
+        while (true) {
+            auto it = showtimeSales.lower_bound(first);
+            if (it == showtimeSales.end() || it->first.first != movieID) break;
+            forgetSales(it->first);
+        }
+    }
+
+    bool addUserIfMissing(const vector<string>& tokens, size_t first) {
+        if (tokens.size() < first + 3) return false;
+        for (const auto& user : users) {
+            if (user->getUsername() == tokens[first + 1]) return false;
+        }
+        if (tokens[first] == "CUSTOMER" && tokens.size() >= first + 4) {
+            users.push_back(make_unique<Customer>(tokens[first + 1], tokens[first + 2], tokens[first + 3]));
+        } else if (tokens[first] == "ADMIN") {
+            users.push_back(make_unique<Admin>(tokens[first + 1], tokens[first + 2]));
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Accounts are only ever added, and menus hold pointers to the logged-in
+    // user, so other instances' registrations are merged rather than reloaded
+    void mergeUsersFromFile() {
+        ifstream userFile("users.txt");
+        string line;
+        while (getline(userFile, line)) {
+            vector<string> tokens;
+            string token;
+            istringstream tokenStream(line);
+            while (getline(tokenStream, token, ',')) {
+                tokens.push_back(token);
+            }
+            addUserIfMissing(tokens, 0);
+        }
+    }
+
+    // Archived bookings keep their IDs, so the allocator must continue after
+    // them too. Only the first field of each line is parsed.
+    void observeArchivedIDs() {
+        TraceSpan span("loadData/archivedIDs", "load");
+        ifstream archiveFile("archive_bookings.txt");
+        string line;
+        while (getline(archiveFile, line)) {
+            try {
+                BookingIDAllocator::get().observe(stoi(line.substr(0, line.find(','))));
+            } catch (...) {
+            }
+        }
+    }
+
+    // Rebuilds bookings from the journal's checkpoint and tail, for a
+    // generation another instance started, and repairs the seat maps the
+    // replay touched
+    void reloadBookingsFromJournal() {
+        set<pair<int, string>> changed;
+        if (replayJournal(max(1u, thread::hardware_concurrency()), changed) < 0) loadBookings();
+        rejectedLines.clear();
+        for (const auto& key : changed) {
+            if (findSeats(key)) dirtyShowtimes.insert(key);
+        }
+        reconcileSeats(false);
+    }
+
+    // Replaces movies, halls and seat maps with the files' contents; the
+    // bookings stay, as the journal already brought them up to date. Seat
+    // maps that were resident hold bookings seats.txt may not have yet, so
+    // they are repaired from the bookings again. Only safe where no caller
+    // holds references into them (menu loops).
+    void reloadCatalog() {
+        TraceSpan span("reloadCatalog", "sync");
+        DataLock::Guard guard;
+        vector<pair<int, string>> resident;
+        for (const auto& seats : movieSeats) resident.push_back(seats.first);
+        movieSeats.clear();
+        seatIndex.clear();
+        bookingDigests.clear();
+        dirtyShowtimes.clear();
+        loadMovies();
+        map<pair<int, string>, string> hallAssignments = loadHalls();
+        loadSeats(hallAssignments);
+        loadTombstones();
+        mergeUsersFromFile();
+        rejectedLines.clear();
+        digestsStale = true;
+        for (const auto& key : resident) {
+            if (findSeats(key)) dirtyShowtimes.insert(key);
+        }
+        reconcileSeats(false);
+        catalogPending = false;
+        markChanged();
+    }
+
+    // Applies what other instances committed since the last call. Entries
+    // are replayed one by one; a new generation is replayed from its
+    // checkpoint instead. After a CATALOG entry movies, halls and seat
+    // layouts are reloaded once allowCatalogReload says no caller holds
+    // references into them. Cheap when nothing changed: the watcher answers
+    // without I/O.
+    void syncFromJournal(bool allowCatalogReload) {
+        DataLock::Guard guard;
+        if (journalWatcher.changed()) {
+            TraceSpan span("syncFromJournal", "sync");
+            ifstream journal(JOURNAL_FILE, ios::binary);
+            string header;
+            if (journal.is_open() && getline(journal, header) && header.rfind("#JOURNAL,", 0) == 0) {
+                streamoff entriesStart = header.size() + 1;
+                bool restarted = header.substr(9) != journalGeneration;
+                if (restarted) {
+                    // Entries we have not seen may be gone; the checkpoint has them
+                    journalGeneration = header.substr(9);
+                    journalOffset = entriesStart;
+                    journalBaseEnd = entriesStart;
+                }
+                journal.seekg(max(journalOffset, entriesStart));
+                string pending((istreambuf_iterator<char>(journal)), istreambuf_iterator<char>());
+                size_t complete = pending.rfind('\n');
+                pending.resize(complete == string::npos ? 0 : complete + 1);
+                size_t checkpoint = restarted ? pending.find(",CHECKPOINT,") : string::npos;
+                if (checkpoint != string::npos) journalBaseEnd = entriesStart + pending.find('\n', checkpoint) + 1;
+                journalOffset = max(journalOffset, entriesStart) + pending.size();
+
+                string ownID = to_string(processID());
+                bool catalog = restarted;
+                vector<vector<string>> entries;
+                istringstream lines(pending);
+                string line;
+                while (getline(lines, line)) {
+                    vector<string> tokens;
+                    string token;
+                    istringstream tokenStream(line);
+                    while (getline(tokenStream, token, ',')) {
+                        tokens.push_back(token);
+                    }
+                    if (tokens.size() < 2 || tokens[0] == ownID) continue;
+                    if (tokens[1] == "CATALOG") catalog = true;
+                    else entries.push_back(tokens);
+                }
+
+                if (restarted) {
+                    reloadBookingsFromJournal();
+                } else {
+                    for (const auto& entry : entries) {
+                        try {
+                            applyJournalEntry(entry);
+                        } catch (...) {
+                            // Malformed entry: replay the whole journal
+                            reloadBookingsFromJournal();
+                            break;
+                        }
+                    }
+                }
+                if (catalog) {
+                    mergeUsersFromFile();
+                    catalogPending = true;
+                    reindexSeats();
+                    markChanged();
+                }
+            }
+        }
+        if (allowCatalogReload && catalogPending) reloadCatalog();
+    }
+
+public:
+    // Holds DataLock and defers the journal entries of every commit made
+    // while it lives, then appends them with one write and one fsync. The
+    // caller must not report those commits before the group is closed.
+    class GroupCommit {
+    public:
+        explicit GroupCommit(CinemaBookingSystem& bookingSystem) : system(bookingSystem) { system.groupDepth++; }
+        ~GroupCommit() {
+            if (--system.groupDepth > 0) return;
+            vector<string> entries;
+            entries.swap(system.groupEntries);
+            system.appendJournal(entries);
+        }
+        GroupCommit(const GroupCommit&) = delete;
+        GroupCommit& operator=(const GroupCommit&) = delete;
+
+    private:
+        DataLock::Guard guard;
+        CinemaBookingSystem& system;
+    };
+
+    static CinemaBookingSystem* getInstance() {
+        if (!instance) instance = new CinemaBookingSystem();
+        return instance;
+    }
+
+    // Null unless this instance replicates to a standby
+    const LogShipper* replication() const { return shipper.get(); }
+
+    static void cleanup() {
+        delete instance;
+        instance = nullptr;
+        TraceRecorder::get().flush();
+    }
+
+    // Changes are saved as they are made, so only repairs from loading can
+    // still be unsaved at exit
+    ~CinemaBookingSystem() {
+        if (unsaved) {
+            syncFromJournal(true);
+            saveData();
+        }
+        BookingIDAllocator::get().returnUnused();
+    }
+
+    // Rewrites every data file, after catching up with other instances, and
+    // tells them to reload the catalog. Concurrent catalog edits from two
+    // instances are last-writer-wins; bookings and registrations are merged.
+    void saveData() {
+        TraceSpan span("saveData", "save");
+        DataLock::Guard guard;
+        syncFromJournal(false);
+        reconcileSeats();
+        markChanged();
+        saveUsers();
+        saveMovies();
+        saveHalls();
+        saveSeats();
+        appendJournal("CATALOG");
+        unsaved = false;
+    }
+
+    // The checkpoint appendJournal takes before restarting the journal
+    void saveBookingData() {
+        reconcileSeats();
+        saveBookings();
+        saveSeats();
+    }
+
+    void saveUsers() {
+        TraceSpan span("saveData/users", "save");
+        SummedFile userFile("users.txt");
+        if (userFile.is_open()) {
+            for (const auto& user : users) {
+                if (user->getUserType() == "CUSTOMER") {
+                    Customer* cust = dynamic_cast<Customer*>(user.get());
+                    if (cust) {
+                        userFile << "CUSTOMER," << cust->getUsername() << "," 
+                                << cust->getPassword() << "," << cust->getName() << endl;
+                    }
+                } else if (user->getUserType() == "ADMIN") {
+                    userFile << "ADMIN," << user->getUsername() << "," << user->getPassword() << endl;
+                }
+            }
+            userFile.commit();
+        }
+    }
+
+    void saveMovies() {
+        TraceSpan span("saveData/movies", "save");
+        SummedFile movieFile("movies.txt");
+        if (movieFile.is_open()) {
+            for (const auto& movie : movies) {
+                movieFile << movie.getMovieID() << "," << movie.getTitle() << "," 
+                         << movie.getGenre() << "," << fixed << setprecision(2) << movie.getPrice();
+                for (const auto& sched : movie.getSchedules()) {
+                    movieFile << "," << sched.getDate() << "," << sched.getTime();
+                }
+                movieFile << endl;
+            }
+            movieFile.commit();
+        }
+    }
+
+    void saveBookings() {
+        TraceSpan span("saveData/bookings", "save");
+        SummedFile bookingFile("bookings.txt");
+        if (bookingFile.is_open()) {
+            for (const auto& booking : bookings) {
+                writeBookingLine(bookingFile, booking);
+            }
+            bookingFile.commit();
+        }
+    }
+
+    static void writeBookingLine(ostream& out, const Booking& booking) {
+        out << booking.getBookingID() << "," << booking.getCustomerUsername() << ","
+            << booking.getMovieID() << "," << booking.getSchedule().getDate() << ","
+            << booking.getSchedule().getTime() << "," << booking.getSeat() << ","
+            << fixed << setprecision(2) << booking.getPrice() << "," << booking.getPaymentMode() << endl;
+    }
+
+    static void writeSeatRecord(ostream& out, const pair<int, string>& key, const SeatMap& seats) {
+        out << encodeSeatRecord(key, seats) << '\n';
+    }
+
+    // Copies a showtime's lines from the current seats.txt without parsing them
+    static void copySeatBlock(ifstream& from, const SeatBlock& block, ostream& out) {
+        for (const auto& range : block.ranges) {
+            string buffer(range.second - range.first, '\0');
+            from.clear();
+            from.seekg(range.first);
+            from.read(&buffer[0], buffer.size());
+            buffer.resize(from.gcount());
+            if (!buffer.empty() && buffer.back() != '\n') buffer += '\n';
+            out << buffer;
+        }
+    }
+
+    // Resident seat maps are written out; showtimes that were never paged in
+    // are copied byte for byte from the previous file. Blocks still in the old
+    // line-per-seat format are paged in first so the file is converted. The
+    // new file replaces seats.txt only once it is complete, and the index is
+    // moved to its offsets.
+    void saveSeats() {
+        TraceSpan span("saveData/seats", "save");
+        vector<pair<int, string>> legacyBlocks;
+        for (const auto& indexed : seatIndex) {
+            if (!indexed.second.compact) legacyBlocks.push_back(indexed.first);
+        }
+        for (const auto& key : legacyBlocks) findSeats(key);
+
+        SummedFile seatFile("seats.txt");
+        if (!seatFile.is_open()) return;
+
+        seatFile << SEAT_FORMAT_HEADER << '\n';
+        map<pair<int, string>, SeatBlock> savedBlocks;
+        for (const auto& movieSeatPair : movieSeats) {
+            SeatBlock& saved = savedBlocks[movieSeatPair.first];
+            saved.hall = movieSeatPair.second.getLayout().getName();
+            saved.compact = true;
+            saved.freeSeats = movieSeatPair.second.availableCount();
+            streamoff begin = seatFile.tellp();
+            writeSeatRecord(seatFile, movieSeatPair.first, movieSeatPair.second);
+            saved.ranges.push_back({begin, seatFile.tellp()});
+        }
+
+        map<pair<int, string>, SeatBlock> movedIndex;
+        if (!seatIndex.empty()) {
+            ifstream oldFile("seats.txt", ios::binary);
+            for (const auto& indexed : seatIndex) {
+                SeatBlock moved;
+                moved.hall = indexed.second.hall;
+                moved.compact = true;
+                moved.freeSeats = indexed.second.freeSeats;
+                streamoff begin = seatFile.tellp();
+                copySeatBlock(oldFile, indexed.second, seatFile);
+                moved.ranges.push_back({begin, seatFile.tellp()});
+                movedIndex.emplace(indexed.first, moved);
+            }
+        }
+        if (seatFile.commit()) {
+            seatIndex = movedIndex;
+            residentBlocks = savedBlocks;
+        } else {
+            cerr << "Unable to replace seats.txt" << endl;
+        }
+    }
+
+    void saveHalls() {
+        TraceSpan span("saveData/halls", "save");
+        SummedFile hallFile("halls.txt");
+        if (hallFile.is_open()) {
+            for (const auto& hallPair : halls) {
+                const HallLayout& hall = hallPair.second;
+                hallFile << "HALL," << hall.getName() << "," << hall.getRows() << "," << hall.getSeatsPerRow()
+                         << "," << hall.blockedList() << endl;
+            }
+            for (const auto& movieSeatPair : movieSeats) {
+                const string& hallName = movieSeatPair.second.getLayout().getName();
+                if (hallName != DEFAULT_HALL) {
+                    hallFile << "ASSIGN," << movieSeatPair.first.first << "," << movieSeatPair.first.second
+                             << "," << hallName << endl;
+                }
+            }
+            for (const auto& indexed : seatIndex) {
+                if (indexed.second.hall != DEFAULT_HALL) {
+                    hallFile << "ASSIGN," << indexed.first.first << "," << indexed.first.second
+                             << "," << indexed.second.hall << endl;
+                }
+            }
+            hallFile.commit();
+        }
+    }
+
+    vector<unique_ptr<User>>& getUsers() { return users; }
+    // Callers that change the catalog through this commit it with saveData
+    vector<Movie>& getMovies() { return movies; }
+
+    // Makes the next snapshot copy the movie list again, e.g. after saveData
+    void markChanged() {
+        lock_guard<mutex> lock(stateMutex);
+        catalogVersion = ++stateVersion;
+    }
+
+    // Returns a consistent view of movies and bookings. Under the lock, a new
+    // version takes the booking chunk pointers and, if the catalog changed, a
+    // copy of the listed movies; callers then read it without blocking
+    // addBooking.
+    shared_ptr<const BookingSnapshot> snapshot() {
+        TraceSpan span("snapshot", "report");
+        lock_guard<mutex> lock(stateMutex);
+        if (!cachedSnapshot || cachedSnapshot->version != stateVersion) {
+            if (!snapshotMovies || snapshotMoviesVersion != catalogVersion) {
+                auto listed = make_shared<vector<Movie>>();
+                copy_if(movies.begin(), movies.end(), back_inserter(*listed),
+                        [&](const Movie& m) { return !retiredMovies.count(m.getMovieID()); });
+                snapshotMovies = listed;
+                snapshotMoviesVersion = catalogVersion;
+            }
+            cachedSnapshot = make_shared<const BookingSnapshot>(stateVersion, snapshotMovies, bookings.share(retiredMovies));
+        }
+        return cachedSnapshot;
+    }
+
+    // Search index over the listed movies. Bookings change the snapshot
+    // version but not the catalog, so the index is only rebuilt when a movie
+    // was added, deleted or had its title or genre changed.
+    shared_ptr<const CatalogIndex> catalogIndex() {
+        shared_ptr<const BookingSnapshot> view = snapshot();
+        lock_guard<mutex> lock(indexMutex);
+        if (!cachedIndex || (indexVersion != view->version && !cachedIndex->covers(view->movies))) {
+            cachedIndex = make_shared<const CatalogIndex>(view->movies);
+        }
+        indexVersion = view->version;
+        return cachedIndex;
+    }
+
+    static uint64_t seatHash(const string& seat) { return IntegrityScanner::fnv1a(seat.data(), seat.size()); }
+
+    void noteBooking(const Booking& booking, bool added) {
+        pair<int, string> key(booking.getMovieID(), booking.getSchedule().getFullSchedule());
+        SeatDigest& digest = bookingDigests[key];
+        if (added) {
+            digest.count++;
+            digest.sum += seatHash(booking.getSeat());
+        } else {
+            digest.count--;
+            digest.sum -= seatHash(booking.getSeat());
+        }
+        dirtyShowtimes.insert(key);
+        long long cents = llround(booking.getPrice() * 100);
+        noteSales(key, added ? 1 : -1, added ? cents : -cents);
+    }
+
+    void rebuildDigests() {
+        bookingDigests.clear();
+        showtimeSales.clear();
+        movieDayCents.clear();
+        for (const auto& booking : bookings) {
+            pair<int, string> key(booking.getMovieID(), booking.getSchedule().getFullSchedule());
+            SeatDigest& digest = bookingDigests[key];
+            digest.count++;
+            digest.sum += seatHash(booking.getSeat());
+            long long cents = llround(booking.getPrice() * 100);
+            ShowtimeSales& sales = showtimeSales[key];
+            sales.tickets++;
+            sales.cents += cents;
+            movieDayCents[{key.first, key.second.substr(0, 10)}] += cents;
+        }
+        digestsStale = false;
+        rankingsStale = true;
+    }
+
+    // Capacity of a showtime's hall, without paging its seat map in
+    int showtimeCapacity(const pair<int, string>& key) const {
+        auto resident = movieSeats.find(key);
+        if (resident != movieSeats.end()) return resident->second.getLayout().capacity();
+        auto indexed = seatIndex.find(key);
+        return getHall(indexed != seatIndex.end() ? indexed->second.hall : DEFAULT_HALL).capacity();
+    }
+
+    void rankShowtime(const pair<int, string>& key, int tickets) {
+        int capacity = showtimeCapacity(key);
+        string week = weekStartOf(key.second.substr(0, 10));
+        Leaderboard<pair<int, string>>& board = fillByWeek[week];
+        board.update(key, capacity > 0 ? static_cast<double>(tickets) / capacity : 0.0);
+        if (board.empty()) fillByWeek.erase(week);
+    }
+
+    void rankMovieDay(int movieID, const string& date, long long cents) {
+        Leaderboard<int>& board = revenueByDay[date];
+        board.update(movieID, cents / 100.0);
+        if (board.empty()) revenueByDay.erase(date);
+    }
+
+    // Adds tickets and revenue (either may be negative) to a showtime's
+    // counters and moves it and its movie in the rankings
+    void noteSales(const pair<int, string>& key, int tickets, long long cents) {
+        ShowtimeSales& sales = showtimeSales[key];
+        sales.tickets += tickets;
+        sales.cents += cents;
+        int ticketsNow = sales.tickets;
+        if (ticketsNow <= 0) showtimeSales.erase(key);
+
+        pair<int, string> movieDay(key.first, key.second.substr(0, 10));
+        long long& dayCents = movieDayCents[movieDay];
+        dayCents += cents;
+        long long centsNow = dayCents;
+        if (centsNow <= 0) movieDayCents.erase(movieDay);
+
+        if (rankingsStale) return;
+        rankShowtime(key, ticketsNow);
+        rankMovieDay(movieDay.first, movieDay.second, centsNow);
+    }
+
+    // Takes a removed showtime's tickets out of the counters
+    void forgetSales(pair<int, string> key) {
+        auto it = showtimeSales.find(key);
+        if (it == showtimeSales.end()) return;
+        ShowtimeSales sales = it->second;
+        noteSales(key, -sales.tickets, -sales.cents);
+    }
+
+    void rerank() {
+        fillByWeek.clear();
+        revenueByDay.clear();
+        for (const auto& entry : showtimeSales) rankShowtime(entry.first, entry.second.tickets);
+        for (const auto& entry : movieDayCents) rankMovieDay(entry.first.first, entry.first.second, entry.second);
+        rankingsStale = false;
+    }
+
+    // Rebuilds the digests and counters if bookings were reloaded from file;
+    // every resident seat map is then checked again
+    void refreshDigests() {
+        if (!digestsStale) return;
+        rebuildDigests();
+        for (const auto& resident : movieSeats) dirtyShowtimes.insert(resident.first);
+    }
+
+    static SeatDigest seatMapDigest(const SeatMap& seats) {
+        SeatDigest digest;
+        const vector<uint64_t>& words = seats.getBookedBits();
+        for (size_t w = 0; w < words.size(); w++) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                int index = w * 64 + popcount64((bits & (~bits + 1)) - 1);
+                digest.count++;
+                digest.sum += seatHash(seats.getLayout().seatLabel(index));
+            }
+        }
+        return digest;
+    }
+
+    // Books exactly the seats that bookings hold for this showtime. Seats an
+    // admin removed are re-opened if a booking still refers to them. Returns
+    // true if the seat map changed.
+    bool restoreFromBookings(SeatMap& seats, const vector<const Booking*>& showtimeBookings) {
+        vector<uint64_t> before = seats.getBookedBits();
+        for (int i = 0; i < seats.getLayout().positions(); i++) seats.release(i);
+        for (const Booking* booking : showtimeBookings) {
+            int index = seats.indexOf(booking->getSeat());
+            if (index < 0 || seats.getLayout().isBlocked(index)) continue;
+            seats.openSeat(index);
+            seats.book(index);
+        }
+        return seats.getBookedBits() != before;
+    }
+
+    // Checks every showtime touched since the last call against its booking
+    // digest and repairs the seat maps that disagree. Called before each save,
+    // so every mutation batch is verified before it reaches disk. Repairs are
+    // expected, not reported, after bookings were reread from disk.
+    int reconcileSeats(bool report = true) {
+        TraceSpan span("reconcileSeats", "save");
+        refreshDigests();
+        int repaired = 0;
+        for (const auto& key : dirtyShowtimes) {
+            auto resident = movieSeats.find(key);
+            if (resident == movieSeats.end()) continue;
+            auto expected = bookingDigests.find(key);
+            SeatDigest wanted = expected != bookingDigests.end() ? expected->second : SeatDigest();
+            if (seatMapDigest(resident->second) == wanted) continue;
+
+            vector<const Booking*> showtimeBookings;
+            for (const auto& booking : bookings) {
+                if (booking.getMovieID() == key.first && booking.getSchedule().getFullSchedule() == key.second) {
+                    showtimeBookings.push_back(&booking);
+                }
+            }
+            if (restoreFromBookings(resident->second, showtimeBookings)) repaired++;
+        }
+        dirtyShowtimes.clear();
+        if (repaired > 0 && report) {
+            cerr << "Reconciled " << repaired << " showtime seat map(s) with bookings." << endl;
+        }
+        return repaired;
+    }
+
+    // Reconstructs the booked seats of every showtime from bookings in one
+    // pass. Returns the number of seat maps that changed.
+    int rebuildSeatsFromBookings() {
+        TraceSpan span("rebuildSeats", "save");
+        vector<pair<int, string>> paged = loadAllSeats();
+        map<pair<int, string>, vector<const Booking*>> byShowtime;
+        for (const auto& booking : bookings) {
+            pair<int, string> key(booking.getMovieID(), booking.getSchedule().getFullSchedule());
+            if (movieSeats.count(key)) byShowtime[key].push_back(&booking);
+        }
+        int changed = 0;
+        for (auto& resident : movieSeats) {
+            if (restoreFromBookings(resident.second, byShowtime[resident.first])) changed++;
+        }
+        rebuildDigests();
+        dirtyShowtimes.clear();
+        saveData();
+        evictSeats(paged);
+        return changed;
+    }
+
+    // Seat management interface
+    void initializeSeatsForNewMovie(int movieID, const string& showtime, const string& hallName = DEFAULT_HALL) {
+        initializeSeatsForMovie(movieID, showtime, hallName);
+    }
+
+    // Schedules many showtimes ("YYYY-MM-DD HH:MM", ascending) of one movie
+    // in one hall. Every seat map is a copy of a single empty map of the hall
+    // and the files are saved once. Showtimes the movie already has are
+    // skipped. Returns the number added.
+    int addShowtimes(int movieID, const vector<string>& showtimes, const string& hallName) {
+        auto movie = find_if(movies.begin(), movies.end(), [&](const Movie& m) { return m.getMovieID() == movieID; });
+        if (movie == movies.end()) return 0;
+        set<string> scheduled;
+        for (const auto& schedule : movie->getSchedules()) scheduled.insert(schedule.getFullSchedule());
+
+        vector<string> added;
+        for (const auto& showtime : showtimes) {
+            if (scheduled.insert(showtime).second) added.push_back(showtime);
+        }
+        if (added.empty()) return 0;
+        for (const auto& showtime : added) reviveShowtime(movieID, showtime);
+
+        const SeatMap empty(getHall(hallName));
+        {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            movie->reserveSchedules(added.size());
+            for (const auto& showtime : added) {
+                movie->addSchedule(Schedule(showtime.substr(0, 10), showtime.substr(11)));
+                pair<int, string> key(movieID, showtime);
+                seatIndex.erase(key);
+                auto slot = movieSeats.lower_bound(key);
+                if (slot != movieSeats.end() && slot->first == key) slot->second = empty;
+                else movieSeats.emplace_hint(slot, key, empty);
+                dirtyShowtimes.insert(key);
+            }
+        }
+        saveData();
+        return added.size();
+    }
+
+    void removeSeatsForMovie(int movieID, const string& showtime) {
+        seatIndex.erase({movieID, showtime});
+        movieSeats.erase({movieID, showtime});
+        bookingDigests.erase({movieID, showtime});
+        dirtyShowtimes.erase({movieID, showtime});
+        forgetSales({movieID, showtime});
+    }
+
+    bool hasBookingsForSchedule(int movieID, const string& showtime) const {
+        return any_of(bookings.begin(), bookings.end(), 
+            [&](const Booking& b) { 
+                return b.getMovieID() == movieID && b.getSchedule().getFullSchedule() == showtime; 
+            });
+    }
+
+    bool isSeatAvailable(int movieID, const string& showtime, const string& seat) const {
+        const SeatMap* seats = findSeats({movieID, showtime});
+        return seats && seats->isAvailable(seats->indexOf(seat));
+    }
+
+    // Free seats left for a showtime, or -1 if it has no seat map. A showtime
+    // on disk is answered from its index entry, so listings that show the
+    // count for every showtime do not page the seat maps in.
+    int remainingSeats(int movieID, const string& showtime) const {
+        pair<int, string> key(movieID, showtime);
+        auto indexed = seatIndex.find(key);
+        if (indexed != seatIndex.end() && indexed->second.freeSeats >= 0) return indexed->second.freeSeats;
+        const SeatMap* seats = findSeats(key);
+        return seats ? seats->availableCount() : -1;
+    }
+
+    // "N left" / "SOLD OUT" tag shown next to a showtime in listings
+    string availabilityLabel(int movieID, const string& showtime) const {
+        int remaining = remainingSeats(movieID, showtime);
+        if (remaining < 0) return "";
+        if (remaining == 0) return RED + "SOLD OUT" + RESET;
+        return (remaining <= 10 ? YELLOW : GREEN) + to_string(remaining) + " left" + RESET;
+    }
+
+    bool seatExists(int movieID, const string& showtime, const string& seat) const {
+        const SeatMap* seats = findSeats({movieID, showtime});
+        return seats && seats->hasSeat(seats->indexOf(seat));
+    }
+
+    void bookSeat(int movieID, const string& showtime, const string& seat) {
+        SeatMap* seats = findSeats({movieID, showtime});
+        if (seats) seats->book(seats->indexOf(seat));
+        dirtyShowtimes.insert({movieID, showtime});
+    }
+
+    void freeSeat(int movieID, const string& showtime, const string& seat) {
+        SeatMap* seats = findSeats({movieID, showtime});
+        if (seats) seats->release(seats->indexOf(seat));
+        dirtyShowtimes.insert({movieID, showtime});
+    }
+
+    // Re-opens a position of the hall grid that has no seat for this showtime
+    bool addSeat(int movieID, const string& showtime, const string& seat) {
+        SeatMap* seats = findSeats({movieID, showtime});
+        if (!seats) return false;
+        int index = seats->indexOf(seat);
+        if (index < 0 || seats->hasSeat(index)) return false;
+        seats->openSeat(index);
+        dirtyShowtimes.insert({movieID, showtime});
+        return true;
+    }
+
+    // Takes an unbooked seat out of this showtime
+    bool removeSeat(int movieID, const string& showtime, const string& seat) {
+        SeatMap* seats = findSeats({movieID, showtime});
+        if (!seats) return false;
+        int index = seats->indexOf(seat);
+        if (!seats->isAvailable(index)) return false;
+        seats->closeSeat(index);
+        dirtyShowtimes.insert({movieID, showtime});
+        return true;
+    }
+
+    // Hall layout interface
+    const map<string, HallLayout>& getHalls() const { return halls; }
+
+    const HallLayout& getHall(const string& name) const {
+        auto it = halls.find(name);
+        return it != halls.end() ? it->second : halls.at(DEFAULT_HALL);
+    }
+
+    bool isHallInUse(const string& name) const {
+        for (const auto& movieSeatPair : movieSeats) {
+            if (movieSeatPair.second.getLayout().getName() == name) return true;
+        }
+        for (const auto& indexed : seatIndex) {
+            if (indexed.second.hall == name) return true;
+        }
+        return false;
+    }
+
+    // Adds or replaces a layout. Layouts already attached to showtimes are
+    // fixed, since their seat maps point at them.
+    bool defineHall(const HallLayout& hall) {
+        if (hall.getName() == DEFAULT_HALL || isHallInUse(hall.getName())) return false;
+        halls.erase(hall.getName());
+        halls.emplace(hall.getName(), hall);
+        return true;
+    }
+
+    bool removeHall(const string& name) {
+        if (name == DEFAULT_HALL || isHallInUse(name)) return false;
+        return halls.erase(name) > 0;
+    }
+
+    string getShowtimeHall(int movieID, const string& showtime) const {
+        auto indexed = seatIndex.find({movieID, showtime});
+        if (indexed != seatIndex.end()) return indexed->second.hall;
+        auto it = movieSeats.find({movieID, showtime});
+        return it != movieSeats.end() ? it->second.getLayout().getName() : DEFAULT_HALL;
+    }
+
+    // Moves a showtime with a seat map and no bookings into another hall
+    bool setShowtimeHall(int movieID, const string& showtime, const string& hallName) {
+        if (!halls.count(hallName) || !findSeats({movieID, showtime}) || hasBookingsForSchedule(movieID, showtime)) {
+            return false;
+        }
+        initializeSeatsForMovie(movieID, showtime, hallName);
+        return true;
+    }
+
+    // The best free seats for a party of count, side by side in one row;
+    // empty if no row has room
+    vector<string> recommendSeats(int movieID, const string& showtime, int count = 1) const {
+        vector<string> labels;
+        const SeatMap* seats = findSeats({movieID, showtime});
+        if (!seats) return labels;
+        SeatRecommender::Pick pick = SeatRecommender::best(*seats, count);
+        for (int i = 0; i < pick.count; i++) labels.push_back(seats->getLayout().seatLabel(pick.first + i));
+        return labels;
+    }
+
+    void displaySeatLayout(int movieID, const string& showtime, ostream& out = cout) const {
+        const SeatMap* found = findSeats({movieID, showtime});
+        if (!found) {
+            out << "\n\t╔═══════════════════════════════════╗" << endl;
+            out << YELLOW << "\t║   No seat data for this date      ║" << RESET << endl;
+            out << "\t╚═══════════════════════════════════╝" << endl;
+            return;
+        }
+
+        const SeatMap& seats = *found;
+        const HallLayout& hall = seats.getLayout();
+        int gridWidth = hall.getSeatsPerRow() * 3 + 1;
+        int suggested = SeatRecommender::best(seats, 1).first;
+
+        out << "\n\t╔═══════════════════════════════════════════════╗" << endl;
+        out << CYAN << "\t║                    SCREEN                     ║" << RESET << endl;
+        out << "\t╚═══════════════════════════════════════════════╝" << endl;
+        out << "\t  Hall: " << YELLOW << hall.getName() << RESET << endl;
+        
+        // Display column numbers
+        out << "\n\t       ";
+        for (int num = 1; num <= hall.getSeatsPerRow(); num++) {
+            out << YELLOW << setw(3) << num << RESET;
+        }
+        out << endl;
+
+        // Create horizontal line using individual characters
+        out << "\t     ╔";
+        for (int i = 0; i < gridWidth; i++) out << "═";
+        out << "╗" << endl;
+        
+        // Display seat rows; positions without a seat are left blank
+        for (int row = 0; row < hall.getRows(); row++) {
+            out << "\t  " << YELLOW << static_cast<char>('A' + row) << RESET << "  ║";
+            for (int num = 0; num < hall.getSeatsPerRow(); num++) {
+                int index = row * hall.getSeatsPerRow() + num;
+                if (!seats.hasSeat(index)) {
+                    out << "   ";
+                } else if (index == suggested) {
+                    out << CYAN << "[O]" << RESET;
+                } else if (seats.isAvailable(index)) {
+                    out << " " << GREEN << "O" << RESET << " ";
+                } else {
+                    out << " " << RED << "X" << RESET << " ";
+                }
+            }
+            out << " ║" << endl;
+        }
+        
+        // Create bottom horizontal line using individual characters
+        out << "\t     ╚";
+        for (int i = 0; i < gridWidth; i++) out << "═";
+        out << "╝" << endl;
+
+        // Display key and additional information
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << "\t║    " << GREEN << "O" << RESET << " = Available    " << RED << "X" << RESET << " = Booked    ║" << endl;
+        out << "\t║    " << CYAN << "[O]" << RESET << " = Suggested seat           ║" << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
+    }
+
+    User* authenticate(const string& username, const string& password) const {
+        for (const auto& u : users) {
+            if (u->getUsername() == username && u->getPassword() == password) return u.get();
+        }
+        return nullptr;
+    }
+
+    // Adds a customer account and announces it to other instances; false if
+    // the username is taken, possibly by another instance just now
+    bool registerCustomer(const string& username, const string& password, const string& name) {
+        DataLock::Guard guard;
+        syncFromJournal(false);
+        if (!addUserIfMissing({"CUSTOMER", username, password, name}, 0)) return false;
+        saveUsers();
+        appendJournal("USER,CUSTOMER," + username + "," + password + "," + name);
+        return true;
+    }
+
+    // Booking commits run under DataLock after replaying other instances'
+    // changes, so a seat sold elsewhere in the meantime is caught here.
+    // Each returns false if the change no longer applies.
+    bool addBooking(const Booking& booking) {
+        vector<Booking> batch = {booking};
+        return addBookings(batch);
+    }
+
+    // Books several seats as one commit: either every booking is added or
+    // none. Bookings without an ID are numbered once the commit is certain
+    // to go ahead (or, for the server, just before they are sent).
+    bool addBookings(vector<Booking>& batch) {
+        TraceSpan span("addBooking", "booking");
+        auto number = [&]() {
+            for (auto& booking : batch) {
+                if (booking.getBookingID() == 0) booking = booking.withID(BookingIDAllocator::get().next());
+            }
+        };
+        if (remote) {
+            number();
+            // The server books one ticket per request; undo the ones that
+            // went through if a later seat is refused
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (remote->book(batch[i])) continue;
+                while (i-- > 0) remote->cancel(batch[i]);
+                syncFromJournal(false);
+                return false;
+            }
+            syncFromJournal(false);
+            return true;
+        }
+        DataLock::Guard guard;
+        syncFromJournal(false);
+        {
+            lock_guard<mutex> lock(stateMutex);
+            set<pair<string, string>> requested; // showtime, seat
+            for (const auto& booking : batch) {
+                string showtime = booking.getSchedule().getFullSchedule();
+                if (!requested.insert({showtime, booking.getSeat()}).second ||
+                    !isBookable(booking.getMovieID(), showtime) ||
+                    !isSeatAvailable(booking.getMovieID(), showtime, booking.getSeat())) {
+                    return false;
+                }
+            }
+            number();
+            stateVersion++;
+            for (const auto& booking : batch) {
+                bookings.push_back(booking);
+                noteBooking(booking, true);
+                bookSeat(booking.getMovieID(), booking.getSchedule().getFullSchedule(), booking.getSeat());
+            }
+        }
+        vector<string> entries;
+        for (const auto& booking : batch) entries.push_back("ADD," + bookingLine(booking));
+        appendJournal(entries);
+        return true;
+    }
+
+    bool removeBooking(int index) {
+        TraceSpan span("removeBooking", "booking");
+        optional<Booking> found = bookingAt(index);
+        if (!found) return false;
+        if (remote) {
+            bool cancelled = remote->cancel(*found);
+            syncFromJournal(false);
+            return cancelled;
+        }
+        DataLock::Guard guard;
+        Booking ticket = *found;
+        syncFromJournal(false);
+        {
+            lock_guard<mutex> lock(stateMutex);
+            index = findBooking(ticket);
+            if (index < 0) return false;
+            stateVersion++;
+            noteBooking(ticket, false);
+            freeSeat(ticket.getMovieID(), ticket.getSchedule().getFullSchedule(), ticket.getSeat());
+            bookings.erase(index);
+        }
+        appendJournal("DEL," + bookingLine(ticket));
+        return true;
+    }
+
+    bool updateBooking(int index, const Schedule& newSchedule, const string& newSeat, double newPrice, const string& newPaymentMode) {
+        TraceSpan span("updateBooking", "booking");
+        optional<Booking> found = bookingAt(index);
+        if (!found) return false;
+        if (remote) {
+            const Booking& ticket = *found;
+            bool changed = remote->change(ticket, Booking(ticket.getBookingID(), ticket.getCustomerUsername(),
+                                                          ticket.getMovieID(), newSchedule, newSeat, newPrice,
+                                                          newPaymentMode));
+            syncFromJournal(false);
+            return changed;
+        }
+        DataLock::Guard guard;
+        Booking ticket = *found;
+        syncFromJournal(false);
+        Booking changed = ticket;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            index = findBooking(ticket);
+            if (index < 0) return false;
+            if (!isBookable(ticket.getMovieID(), newSchedule.getFullSchedule())) return false;
+            bool sameSeat = newSchedule.getFullSchedule() == ticket.getSchedule().getFullSchedule() && newSeat == ticket.getSeat();
+            if (!sameSeat && !isSeatAvailable(ticket.getMovieID(), newSchedule.getFullSchedule(), newSeat)) return false;
+            stateVersion++;
+            noteBooking(ticket, false);
+            freeSeat(ticket.getMovieID(), ticket.getSchedule().getFullSchedule(), ticket.getSeat());
+            changed = Booking(
+                ticket.getBookingID(),
+                ticket.getCustomerUsername(),
+                ticket.getMovieID(),
+                newSchedule,
+                newSeat,
+                newPrice,
+                newPaymentMode
+            );
+            bookings.replace(index, changed);
+            noteBooking(changed, true);
+            bookSeat(changed.getMovieID(), newSchedule.getFullSchedule(), newSeat);
+        }
+        appendJournal("UPD," + bookingLine(ticket) + "," + bookingLine(changed));
+        return true;
+    }
+
+    // Cancels every booking of a showtime in one pass over the bookings and
+    // one commit. The cancelled bookings are appended to cancelled.
+    int cancelShowtimeBookings(int movieID, const string& showtime, vector<Booking>& cancelled) {
+        TraceSpan span("cancelShowtime", "booking");
+        auto inShowtime = [&](const Booking& b) {
+            return b.getMovieID() == movieID && b.getSchedule().getFullSchedule() == showtime;
+        };
+        if (remote) {
+            // The server cancels one ticket per request
+            vector<Booking> tickets;
+            {
+                lock_guard<mutex> lock(stateMutex);
+                copy_if(bookings.begin(), bookings.end(), back_inserter(tickets), inShowtime);
+            }
+            int count = 0;
+            for (const auto& ticket : tickets) {
+                if (!remote->cancel(ticket)) continue;
+                cancelled.push_back(ticket);
+                count++;
+            }
+            syncFromJournal(false);
+            return count;
+        }
+        DataLock::Guard guard;
+        syncFromJournal(false);
+        size_t first = cancelled.size();
+        vector<string> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            size_t erased = bookings.eraseIf([&](const Booking& b) {
+                if (!inShowtime(b)) return false;
+                cancelled.push_back(b);
+                return true;
+            });
+            if (erased == 0) return 0;
+            stateVersion++;
+
+            for (size_t i = first; i < cancelled.size(); i++) {
+                noteBooking(cancelled[i], false);
+                freeSeat(movieID, showtime, cancelled[i].getSeat());
+                entries.push_back("DEL," + bookingLine(cancelled[i]));
+            }
+        }
+        appendJournal(entries);
+        return cancelled.size() - first;
+    }
+
+    // Moves every booking of a showtime to another showtime of the same movie
+    // in one pass and one commit, all or nothing. A booking keeps its seat if
+    // it is free there and otherwise gets the best suggested free seat; price
+    // and payment stay as paid. The (before, after) pairs are appended to
+    // moved. Returns false if the target has no seat map, is not bookable,
+    // is the source itself or has too few free seats. The plan is made under
+    // stateMutex; a client sends it one change at a time and moves the
+    // bookings back if the server refuses one.
+    bool moveShowtimeBookings(int movieID, const string& fromShowtime, const string& toShowtime,
+                              vector<pair<Booking, Booking>>& moved) {
+        TraceSpan span("moveShowtime", "booking");
+        optional<DataLock::Guard> guard; // the server locks for remote commits
+        if (!remote) {
+            guard.emplace();
+            syncFromJournal(false);
+        }
+        Schedule schedule(toShowtime.substr(0, 10), toShowtime.substr(11));
+        vector<size_t> indices;
+        vector<pair<Booking, Booking>> changes;
+        vector<string> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            SeatMap* target = findSeats({movieID, toShowtime});
+            if (!target || fromShowtime == toShowtime || !isBookable(movieID, toShowtime)) return false;
+
+            for (size_t pos = 0; pos < bookings.slots(); pos++) {
+                const Booking* b = bookings.at(pos);
+                if (b && b->getMovieID() == movieID && b->getSchedule().getFullSchedule() == fromShowtime) indices.push_back(pos);
+            }
+            if (indices.empty()) return true;
+            if (static_cast<int>(indices.size()) > target->availableCount()) return false;
+
+            // Seats on the target: current seats first, then the best free ones
+            SeatMap planned = *target;
+            vector<string> seats(indices.size());
+            for (size_t j = 0; j < indices.size(); j++) {
+                const string& seat = bookings.at(indices[j])->getSeat();
+                if (planned.book(planned.indexOf(seat))) seats[j] = seat;
+            }
+            for (size_t j = 0; j < indices.size(); j++) {
+                if (!seats[j].empty()) continue;
+                SeatRecommender::Pick pick = SeatRecommender::best(planned, 1);
+                if (pick.first < 0) return false;
+                planned.book(pick.first);
+                seats[j] = planned.getLayout().seatLabel(pick.first);
+            }
+            for (size_t j = 0; j < indices.size(); j++) {
+                const Booking& b = *bookings.at(indices[j]);
+                changes.push_back({b, Booking(b.getBookingID(), b.getCustomerUsername(), movieID, schedule, seats[j],
+                                              b.getPrice(), b.getPaymentMode())});
+            }
+
+            if (!remote) {
+                stateVersion++;
+                for (size_t j = 0; j < indices.size(); j++) {
+                    const Booking& before = changes[j].first;
+                    const Booking& after = changes[j].second;
+                    noteBooking(before, false);
+                    freeSeat(movieID, fromShowtime, before.getSeat());
+                    bookings.replace(indices[j], after);
+                    noteBooking(after, true);
+                    bookSeat(movieID, toShowtime, after.getSeat());
+                    entries.push_back("UPD," + bookingLine(before) + "," + bookingLine(after));
+                }
+            }
+        }
+
+        if (remote) {
+            for (size_t j = 0; j < changes.size(); j++) {
+                if (remote->change(changes[j].first, changes[j].second)) continue;
+                while (j-- > 0) remote->change(changes[j].second, changes[j].first);
+                syncFromJournal(false);
+                return false;
+            }
+            syncFromJournal(false);
+            moved.insert(moved.end(), changes.begin(), changes.end());
+            return true;
+        }
+
+        appendJournal(entries);
+        moved.insert(moved.end(), changes.begin(), changes.end());
+        return true;
+    }
+
+    // Position of a booking in the booking list, or -1
+    int findBookingByID(int bookingID) const {
+        lock_guard<mutex> lock(stateMutex);
+        for (size_t pos = 0; pos < bookings.slots(); pos++) {
+            const Booking* booking = bookings.at(pos);
+            if (booking && booking->getBookingID() == bookingID) return pos;
+        }
+        return -1;
+    }
+
+    // The customer's live bookings in booking order, from the per-customer
+    // index; those of deleted movies are left out like in snapshots
+    vector<Booking> bookingsOf(const string& username) const {
+        lock_guard<mutex> lock(stateMutex);
+        vector<Booking> own;
+        for (size_t pos : bookings.positionsOf(username)) {
+            const Booking* booking = bookings.at(pos);
+            if (!retiredMovies.count(booking->getMovieID())) own.push_back(*booking);
+        }
+        return own;
+    }
+
+    // Copy of the booking at a position, if there still is one
+    optional<Booking> bookingAt(int index) const {
+        lock_guard<mutex> lock(stateMutex);
+        const Booking* booking = index < 0 ? nullptr : bookings.at(index);
+        if (!booking) return nullopt;
+        return *booking;
+    }
+
+    int findBookingLocked(const Booking& ticket) const {
+        lock_guard<mutex> lock(stateMutex);
+        return findBooking(ticket);
+    }
+
+    bool connectToServer(const string& path) {
+        remote = make_unique<BookingClient>();
+        if (remote->connectTo(path)) return true;
+        remote.reset();
+        return false;
+    }
+
+    // Ticket-addressed forms of removeBooking/updateBooking, for requests that
+    // arrive without an index into this instance's booking list
+    bool cancelTicket(const Booking& ticket) {
+        syncFromJournal(false);
+        return removeBooking(findBookingLocked(ticket));
+    }
+
+    bool changeTicket(const Booking& ticket, const Booking& replacement) {
+        syncFromJournal(false);
+        int index = findBookingLocked(ticket);
+        return index >= 0 && ticket.getMovieID() == replacement.getMovieID() &&
+               updateBooking(index, replacement.getSchedule(), replacement.getSeat(), replacement.getPrice(),
+                             replacement.getPaymentMode());
+    }
+
+    // Housekeeping run between menu actions. Each call does a small bounded
+    // amount of work so it never holds up an interactive session. A showtime
+    // only turns past when the date changes, so archiving is tried every
+    // ARCHIVE_CHECK_INTERVAL, or on every pass while full batches remain.
+    void runMaintenance() {
+        syncFromJournal(true);
+        vacuumRetired(VACUUM_BATCH_SIZE);
+        auto now = chrono::steady_clock::now();
+        if (now - lastArchiveCheck >= ARCHIVE_CHECK_INTERVAL) {
+            if (static_cast<size_t>(archivePastShowtimes(ARCHIVE_BATCH_SIZE)) < ARCHIVE_BATCH_SIZE) lastArchiveCheck = now;
+        }
+    }
+
+    // Deleting is O(1): the movie or showtime disappears from every listing
+    // at once and the vacuum removes its data later
+    void retireMovie(int movieID) { retire({"MOVIE", to_string(movieID)}); }
+    void retireShowtime(int movieID, const string& showtime) {
+        retire({"SHOWTIME", to_string(movieID), showtime});
+    }
+
+    // Clears the tombstone of a deleted showtime that is scheduled again, so
+    // neither the vacuum nor the next load removes the new one. Whatever the
+    // old showtime left (bookings, seat map) goes now, so it starts empty;
+    // the dropped bookings are journaled and the caller's saveData persists
+    // the catalog.
+    void reviveShowtime(int movieID, const string& showtime) {
+        pair<int, string> key(movieID, showtime);
+        if (!retiredShowtimes.count(key)) return;
+        DataLock::Guard guard;
+        vector<string> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            retiredShowtimes.erase(key);
+            bookings.eraseIf([&](const Booking& b) {
+                if (b.getMovieID() != movieID || b.getSchedule().getFullSchedule() != showtime) return false;
+                entries.push_back("DEL," + bookingLine(b));
+                return true;
+            });
+        }
+        removeSeatsForMovie(movieID, showtime);
+        saveTombstones();
+        appendJournal(entries);
+    }
+
+    bool isRetired(int movieID) const { return retiredMovies.count(movieID) > 0; }
+
+    // True if tickets can be sold for the showtime: its movie is listed and
+    // the showtime is on the movie's schedule and not deleted. Commits check
+    // this after syncing, since callers validated against an older state.
+    bool isBookable(int movieID, const string& showtime) const {
+        if (retiredMovies.count(movieID) || retiredShowtimes.count({movieID, showtime})) return false;
+        for (const auto& movie : movies) {
+            if (movie.getMovieID() != movieID) continue;
+            for (const auto& schedule : movie.getSchedules()) {
+                if (schedule.getFullSchedule() == showtime) return true;
+            }
+        }
+        return false;
+    }
+
+    // The movies the menus offer: catalog order, deleted ones left out
+    vector<Movie*> listedMovies() {
+        vector<Movie*> listed;
+        for (auto& movie : movies) {
+            if (!retiredMovies.count(movie.getMovieID())) listed.push_back(&movie);
+        }
+        return listed;
+    }
+
+    Movie* findListedMovie(int movieID) {
+        if (retiredMovies.count(movieID)) return nullptr;
+        for (auto& movie : movies) {
+            if (movie.getMovieID() == movieID) return &movie;
+        }
+        return nullptr;
+    }
+
+    // Physically removes up to maxShowtimes deleted showtimes, counting those
+    // of deleted movies, with their bookings and seat maps; then the deleted
+    // movies with no showtimes left. One pass over the bookings per batch,
+    // which then writes movies, bookings, seats and tombstones only and
+    // journals the removed bookings. Returns the number of showtimes removed.
+    int vacuumRetired(size_t maxShowtimes) {
+        if (retiredMovies.empty() && retiredShowtimes.empty()) return 0;
+        DataLock::Guard guard;
+        syncFromJournal(true);
+        if (retiredMovies.empty() && retiredShowtimes.empty()) return 0;
+        TraceSpan span("vacuumRetired", "vacuum");
+
+        set<pair<int, string>> batch;
+        set<int> finished; // deleted movies with every showtime in this or an earlier batch
+        vector<string> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            while (!retiredShowtimes.empty() && batch.size() < maxShowtimes) {
+                batch.insert(*retiredShowtimes.begin());
+                retiredShowtimes.erase(retiredShowtimes.begin());
+            }
+            for (auto& movie : movies) {
+                if (!retiredMovies.count(movie.getMovieID())) continue;
+                while (!movie.getSchedules().empty() && batch.size() < maxShowtimes) {
+                    batch.insert({movie.getMovieID(), movie.getSchedules().back().getFullSchedule()});
+                    movie.removeSchedule(movie.getSchedules().size() - 1);
+                }
+                if (movie.getSchedules().empty()) finished.insert(movie.getMovieID());
+            }
+            for (int movieID : retiredMovies) {
+                // Another instance's vacuum removed this one already
+                if (none_of(movies.begin(), movies.end(), [&](const Movie& m) { return m.getMovieID() == movieID; })) {
+                    finished.insert(movieID);
+                }
+            }
+
+            bookings.eraseIf([&](const Booking& b) {
+                if (!finished.count(b.getMovieID()) &&
+                    !batch.count({b.getMovieID(), b.getSchedule().getFullSchedule()})) {
+                    return false;
+                }
+                entries.push_back("DEL," + bookingLine(b));
+                return true;
+            });
+            movies.erase(remove_if(movies.begin(), movies.end(),
+                                   [&](const Movie& m) { return finished.count(m.getMovieID()) > 0; }),
+                         movies.end());
+            for (int movieID : finished) retiredMovies.erase(movieID);
+        }
+        for (const auto& key : batch) removeSeatsForMovie(key.first, key.second);
+        for (int movieID : finished) dropShowtimesOf(movieID);
+
+        // Users and halls did not change
+        reconcileSeats();
+        saveMovies();
+        saveSeats();
+        saveTombstones();
+        entries.push_back("CATALOG");
+        appendJournal(entries);
+        return batch.size();
+    }
+
+    // Moves up to maxShowtimes showtimes dated before today, with their
+    // bookings and seat maps, out of the live files and appends them to
+    // archive_bookings.txt / archive_seats.txt (same record formats as the live
+    // files). Returns the number of showtimes archived.
+    //
+    // The batch is recorded in ARCHIVE_PENDING_FILE, with the archive sizes
+    // before the append, until the live files are saved. movies.txt is saved
+    // first and is the commit point: settleArchive finishes or undoes a batch
+    // that was interrupted, so no record is ever archived twice.
+    int archivePastShowtimes(size_t maxShowtimes) {
+        DataLock::Guard guard;
+        syncFromJournal(true);
+        settleArchive();
+        string today = currentDate();
+        vector<pair<int, string>> batch;
+        for (const auto& movie : movies) {
+            for (const auto& schedule : movie.getSchedules()) {
+                if (schedule.getDate() < today && batch.size() < maxShowtimes) {
+                    batch.push_back({movie.getMovieID(), schedule.getFullSchedule()});
+                }
+            }
+        }
+        if (batch.empty()) return 0;
+
+        TraceSpan span("archivePastShowtimes", "archive");
+        set<pair<int, string>> archived(batch.begin(), batch.end());
+
+        error_code error;
+        uintmax_t bookingsSize = filesystem::file_size("archive_bookings.txt", error);
+        if (error) bookingsSize = 0;
+        uintmax_t seatsSize = filesystem::file_size("archive_seats.txt", error);
+        if (error) seatsSize = 0;
+        {
+            ofstream pending(ARCHIVE_PENDING_FILE + ".tmp", ios::trunc);
+            pending << bookingsSize << "," << seatsSize << '\n';
+            for (const auto& key : batch) pending << key.first << "," << key.second << '\n';
+            if (!pending.flush()) return 0;
+        }
+        if (!replaceFile(ARCHIVE_PENDING_FILE + ".tmp", ARCHIVE_PENDING_FILE)) return 0;
+
+        ofstream archiveSeats("archive_seats.txt", ios::app | ios::binary);
+        if (archiveSeats.tellp() == 0) archiveSeats << SEAT_FORMAT_HEADER << '\n';
+        ifstream liveSeats("seats.txt", ios::binary);
+        for (const auto& key : batch) {
+            auto indexed = seatIndex.find(key);
+            if (indexed != seatIndex.end() && indexed->second.compact) {
+                copySeatBlock(liveSeats, indexed->second, archiveSeats);
+            } else if (const SeatMap* seats = findSeats(key)) {
+                writeSeatRecord(archiveSeats, key, *seats);
+            }
+        }
+        archiveSeats.close();
+        liveSeats.close();
+
+        ofstream archiveBookings("archive_bookings.txt", ios::app);
+        vector<string> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            stateVersion++;
+            auto isArchived = [&](const Booking& b) {
+                return archived.count({b.getMovieID(), b.getSchedule().getFullSchedule()}) > 0;
+            };
+            for (const auto& booking : bookings) {
+                if (!isArchived(booking)) continue;
+                writeBookingLine(archiveBookings, booking);
+                entries.push_back("DEL," + bookingLine(booking));
+            }
+            bookings.eraseIf(isArchived);
+        }
+        archiveBookings.close();
+        // The appends must be on disk before movies.txt commits the batch
+        syncPath("archive_seats.txt");
+        syncPath("archive_bookings.txt");
+
+        {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            for (auto& movie : movies) {
+                const vector<Schedule>& schedules = movie.getSchedules();
+                for (int i = schedules.size() - 1; i >= 0; i--) {
+                    pair<int, string> key(movie.getMovieID(), schedules[i].getFullSchedule());
+                    if (archived.count(key)) {
+                        removeSeatsForMovie(key.first, key.second);
+                        movie.removeSchedule(i);
+                    }
+                }
+            }
+        }
+
+        // Users, halls and tombstones did not change
+        reconcileSeats();
+        saveMovies();
+        saveSeats();
+        entries.push_back("CATALOG");
+        appendJournal(entries);
+        std::remove(ARCHIVE_PENDING_FILE.c_str());
+        return batch.size();
+    }
+
+    // Resolves an archive batch interrupted before its marker was removed.
+    // If its showtimes are still scheduled, movies.txt was never saved and
+    // the archive is cut back to its size before the batch, which is then
+    // archived again. Otherwise the batch is finished: whatever bookings and
+    // seat maps of it are still live are dropped and saved.
+    void settleArchive() {
+        ifstream pending(ARCHIVE_PENDING_FILE);
+        if (!pending.is_open()) return;
+        uintmax_t bookingsSize = 0, seatsSize = 0;
+        char comma = 0;
+        bool valid = static_cast<bool>(pending >> bookingsSize >> comma >> seatsSize);
+        set<pair<int, string>> batch;
+        string line;
+        getline(pending, line);
+        while (valid && getline(pending, line)) {
+            size_t split = line.find(',');
+            try {
+                batch.insert({stoi(line.substr(0, split)), line.substr(split + 1)});
+            } catch (...) {
+                valid = false;
+            }
+        }
+        pending.close();
+
+        bool scheduled = false;
+        for (const auto& movie : movies) {
+            for (const auto& schedule : movie.getSchedules()) {
+                scheduled = scheduled || batch.count({movie.getMovieID(), schedule.getFullSchedule()});
+            }
+        }
+        if (valid && scheduled) {
+            error_code error;
+            filesystem::resize_file("archive_bookings.txt", bookingsSize, error);
+            filesystem::resize_file("archive_seats.txt", seatsSize, error);
+        } else if (valid) {
+            vector<string> entries;
+            {
+                lock_guard<mutex> lock(stateMutex);
+                stateVersion++;
+                bookings.eraseIf([&](const Booking& b) {
+                    if (!batch.count({b.getMovieID(), b.getSchedule().getFullSchedule()})) return false;
+                    entries.push_back("DEL," + bookingLine(b));
+                    return true;
+                });
+            }
+            for (const auto& key : batch) removeSeatsForMovie(key.first, key.second);
+            reconcileSeats();
+            saveSeats();
+            entries.push_back("CATALOG");
+            appendJournal(entries);
+        }
+        std::remove(ARCHIVE_PENDING_FILE.c_str());
+    }
+
+    // The customer's bookings of archived showtimes, in archive order
+    vector<Booking> archivedBookingsOf(const string& username) const {
+        vector<Booking> found;
+        ifstream archiveFile("archive_bookings.txt");
+        string line;
+        while (getline(archiveFile, line)) {
+            vector<string> tokens;
+            string token;
+            istringstream tokenStream(line);
+            while (getline(tokenStream, token, ',')) tokens.push_back(token);
+            if (tokens.size() < 2 || tokens[1] != username) continue;
+            try {
+                found.push_back(bookingFromTokens(tokens, 0));
+            } catch (...) {
+            }
+        }
+        return found;
+    }
+
+    // Tickets and revenue per movie ID from archive_bookings.txt, streamed
+    map<int, pair<int, double>> archivedSales() const {
+        TraceSpan span("archivedSales", "report");
+        map<int, pair<int, double>> stats;
+        ifstream archiveFile("archive_bookings.txt");
+        string line;
+        while (getline(archiveFile, line)) {
+            vector<string> tokens;
+            string token;
+            istringstream tokenStream(line);
+            while (getline(tokenStream, token, ',')) {
+                tokens.push_back(token);
+            }
+            if (tokens.size() < 7) continue;
+            try {
+                auto& entry = stats[stoi(tokens[2])];
+                entry.first++;
+                entry.second += stod(tokens[6]);
+            } catch (...) {
+                continue;
+            }
+        }
+        return stats;
+    }
+
+    // Showtimes of the week starting weekStart (a Monday) with the largest
+    // share of seats sold, best first. O(K) while the rankings are current.
+    vector<pair<pair<int, string>, double>> topShowtimesByFill(const string& weekStart, size_t k) {
+        refreshDigests();
+        if (rankingsStale) rerank();
+        auto board = fillByWeek.find(weekStart);
+        if (board == fillByWeek.end()) return {};
+        return board->second.top(k, [&](const pair<int, string>& key) {
+            return !retiredMovies.count(key.first) && !retiredShowtimes.count(key);
+        });
+    }
+
+    // Movies with the most revenue from showtimes on date, best first
+    vector<pair<int, double>> topMoviesByRevenue(const string& date, size_t k) {
+        refreshDigests();
+        if (rankingsStale) rerank();
+        auto board = revenueByDay.find(date);
+        if (board == revenueByDay.end()) return {};
+        return board->second.top(k, [&](int movieID) { return !retiredMovies.count(movieID); });
+    }
+
+    // Seat occupancy aggregated over a set of showtimes in one hall
+    struct OccupancyReport {
+        struct SlotStats {
+            int showtimes = 0;
+            long long seats = 0;
+            long long booked = 0;
+        };
+        const HallLayout* hall = nullptr;
+        int showtimes = 0;
+        vector<int> bookedPerSeat; // indexed by grid position
+        vector<int> openPerSeat;
+        map<string, SlotStats> slots; // time of day -> totals
+        double seconds = 0.0;
+    };
+
+    // Aggregates every showtime in the given hall, optionally limited to one
+    // movie (movieID 0 = all) and an inclusive date range (empty = unbounded).
+    OccupancyReport occupancyReport(const string& hallName, int movieID, const string& fromDate, const string& toDate) const {
+        TraceSpan span("occupancyReport", "report");
+        auto started = chrono::steady_clock::now();
+        OccupancyReport report;
+        const HallLayout& hall = getHall(hallName);
+        report.hall = &hall;
+
+        vector<pair<int, string>> paged = loadAllSeats();
+        BitSlicedCounter bookedCounter(hall.wordCount());
+        BitSlicedCounter openCounter(hall.wordCount());
+        for (const auto& movieSeatPair : movieSeats) {
+            const SeatMap& seats = movieSeatPair.second;
+            const string& showtime = movieSeatPair.first.second;
+            string date = showtime.substr(0, 10);
+            if (&seats.getLayout() != &hall) continue;
+            if (movieID != 0 && movieSeatPair.first.first != movieID) continue;
+            if (!fromDate.empty() && date < fromDate) continue;
+            if (!toDate.empty() && date > toDate) continue;
+
+            bookedCounter.add(seats.getBookedBits());
+            openCounter.add(seats.getOpenBits());
+            report.showtimes++;
+
+            OccupancyReport::SlotStats& slot = report.slots[showtime.size() > 11 ? showtime.substr(11) : "?"];
+            int seatCount = seats.seatCount();
+            slot.showtimes++;
+            slot.seats += seatCount;
+            slot.booked += seatCount - seats.availableCount();
+        }
+
+        report.bookedPerSeat.resize(hall.positions());
+        report.openPerSeat.resize(hall.positions());
+        for (int i = 0; i < hall.positions(); i++) {
+            report.bookedPerSeat[i] = bookedCounter.countAt(i);
+            report.openPerSeat[i] = openCounter.countAt(i);
+        }
+        evictSeats(paged);
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    // Writes all bookings (and optionally every showtime's seat occupancy) to a
+    // columnar binary file. See ColumnarWriter for the format. Returns the number
+    // of rows written, or -1 if the file could not be created.
+    long long exportColumnar(const string& path, bool includeSeats) {
+        TraceSpan span("exportColumnar", "export");
+        ColumnarWriter writer(path);
+        if (!writer.isOpen()) return -1;
+
+        map<int, string> titles;
+        for (const auto& movie : movies) {
+            titles[movie.getMovieID()] = movie.getTitle();
+        }
+
+        writer.beginTable("bookings", {
+            {"booking_id", ColumnarWriter::INT64},
+            {"customer", ColumnarWriter::DICT_STRING},
+            {"movie_id", ColumnarWriter::INT64},
+            {"movie_title", ColumnarWriter::DICT_STRING},
+            {"date", ColumnarWriter::DICT_STRING},
+            {"time", ColumnarWriter::DICT_STRING},
+            {"seat", ColumnarWriter::DICT_STRING},
+            {"price_cents", ColumnarWriter::INT64},
+            {"payment_mode", ColumnarWriter::DICT_STRING}
+        });
+        for (const auto& booking : bookings) {
+            auto title = titles.find(booking.getMovieID());
+            writer.setInt(0, booking.getBookingID());
+            writer.setString(1, booking.getCustomerUsername());
+            writer.setInt(2, booking.getMovieID());
+            writer.setString(3, title != titles.end() ? title->second : "Unknown");
+            writer.setString(4, booking.getSchedule().getDate());
+            writer.setString(5, booking.getSchedule().getTime());
+            writer.setString(6, booking.getSeat());
+            writer.setInt(7, llround(booking.getPrice() * 100));
+            writer.setString(8, booking.getPaymentMode());
+            writer.endRow();
+        }
+
+        if (includeSeats) {
+            vector<pair<int, string>> paged = loadAllSeats();
+            writer.beginTable("seats", {
+                {"movie_id", ColumnarWriter::INT64},
+                {"showtime", ColumnarWriter::DICT_STRING},
+                {"seat", ColumnarWriter::DICT_STRING},
+                {"booked", ColumnarWriter::UINT8}
+            });
+            for (const auto& movieSeatPair : movieSeats) {
+                const SeatMap& seats = movieSeatPair.second;
+                for (int i = 0; i < seats.getLayout().positions(); i++) {
+                    if (!seats.hasSeat(i)) continue;
+                    writer.setInt(0, movieSeatPair.first.first);
+                    writer.setString(1, movieSeatPair.first.second);
+                    writer.setString(2, seats.getLayout().seatLabel(i));
+                    writer.setInt(3, seats.isBooked(i) ? 1 : 0);
+                    writer.endRow();
+                }
+            }
+            evictSeats(paged);
+        }
+        writer.endTable();
+        return writer.rowsWritten();
+    }
+
+    // Result of a bulk catalog import
+    struct ImportReport {
+        int rowsRead = 0;
+        int rowsImported = 0;
+        int moviesCreated = 0;
+        int showtimesCreated = 0;
+        double seconds = 0.0;
+        vector<string> errors; // "line N: reason"
+    };
+
+    // Streams a catalog file with one showtime per row and adds the movies and
+    // schedules it describes. Accepts CSV (title,genre,price,date,time[,hall], with
+    // an optional header row) or JSONL ({"title":..,"genre":..,"price":..,"date":..,
+    // "time":..,"hall":..}). Rows without a hall use the standard hall.
+    // Rows for a title that is listed already are added to that movie; deleted
+    // movies do not count. The file is parsed first; the rows are then checked
+    // against the catalog and applied as one commit under DataLock, with seat
+    // maps for all new showtimes allocated in one batch and everything saved once.
+    ImportReport importCatalog(const string& path) {
+        TraceSpan span("importCatalog", "import");
+        ImportReport report;
+        auto started = chrono::steady_clock::now();
+
+        ifstream catalogFile(path);
+        if (!catalogFile.is_open()) {
+            report.errors.push_back("cannot open " + path);
+            return report;
+        }
+
+        struct Row {
+            int lineNumber;
+            string title, genre, date, time, hall;
+            double price;
+            string error;
+        };
+        vector<Row> rows;
+        string line;
+        int lineNumber = 0;
+        while (getline(catalogFile, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.find_first_not_of(" \t") == string::npos) continue;
+
+            map<string, string> fields;
+            string error;
+            if (!parseCatalogRow(line, fields, error)) {
+                if (error.empty()) continue; // header row
+                rows.push_back({lineNumber, "", "", "", "", "", 0.0, error});
+                continue;
+            }
+
+            Row row{lineNumber, fields["title"], fields["genre"], fields["date"], fields["time"],
+                    fields["hall"].empty() ? DEFAULT_HALL : fields["hall"], 0.0, ""};
+            try {
+                row.price = stod(fields["price"]);
+            } catch (...) {
+                row.price = 0.0;
+            }
+
+            if (row.title.empty()) row.error = "missing title";
+            else if (row.genre.empty()) row.error = "missing genre";
+            else if (row.title.find(',') != string::npos || row.genre.find(',') != string::npos) row.error = "title and genre cannot contain commas";
+            else if (row.price <= 0) row.error = "invalid price '" + fields["price"] + "'";
+            else if (!isValidDate(row.date)) row.error = "invalid date '" + row.date + "'";
+            else if (!isValidTime(row.time)) row.error = "invalid time '" + row.time + "'";
+            else if (!halls.count(row.hall)) row.error = "unknown hall '" + row.hall + "'";
+            rows.push_back(std::move(row));
+        }
+        catalogFile.close();
+        report.rowsRead = rows.size();
+
+        DataLock::Guard guard;
+        syncFromJournal(false);
+
+        map<string, size_t> movieIndexByTitle;
+        for (size_t i = 0; i < movies.size(); i++) {
+            if (!retiredMovies.count(movies[i].getMovieID())) movieIndexByTitle[movies[i].getTitle()] = i;
+        }
+        set<pair<string, string>> showtimesByTitle; // scheduled or imported: title, "date time"
+        for (const auto& entry : movieIndexByTitle) {
+            for (const auto& sched : movies[entry.second].getSchedules()) {
+                showtimesByTitle.insert({entry.first, sched.getFullSchedule()});
+            }
+        }
+        for (auto& row : rows) {
+            if (row.error.empty() && !showtimesByTitle.insert({row.title, row.date + " " + row.time}).second) {
+                row.error = "duplicate showtime " + row.date + " " + row.time;
+            }
+            if (!row.error.empty()) {
+                report.errors.push_back("line " + to_string(row.lineNumber) + ": " + row.error);
+                continue;
+            }
+            // A showtime deleted earlier leaves its tombstone and old data behind
+            auto found = movieIndexByTitle.find(row.title);
+            if (found != movieIndexByTitle.end()) reviveShowtime(movies[found->second].getMovieID(), row.date + " " + row.time);
+        }
+
+        map<string, vector<pair<int, string>>> newSeatKeysByHall;
+        if (report.errors.size() < rows.size()) {
+            lock_guard<mutex> lock(stateMutex);
+            catalogVersion = ++stateVersion;
+            for (const auto& row : rows) {
+                if (!row.error.empty()) continue;
+                auto found = movieIndexByTitle.find(row.title);
+                if (found == movieIndexByTitle.end()) {
+                    movies.push_back(Movie(row.title, row.genre, row.price));
+                    found = movieIndexByTitle.insert({row.title, movies.size() - 1}).first;
+                    report.moviesCreated++;
+                }
+                Movie& movie = movies[found->second];
+                movie.addSchedule(Schedule(row.date, row.time));
+                newSeatKeysByHall[row.hall].push_back({movie.getMovieID(), row.date + " " + row.time});
+                report.showtimesCreated++;
+                report.rowsImported++;
+            }
+
+            // Every new showtime in a hall starts as a copy of the same empty seat map
+            for (const auto& hallKeys : newSeatKeysByHall) {
+                const SeatMap emptyHall(getHall(hallKeys.first));
+                for (const auto& key : hallKeys.second) {
+                    seatIndex.erase(key);
+                    movieSeats.erase(key);
+                    movieSeats.emplace(key, emptyHall);
+                    dirtyShowtimes.insert(key);
+                }
+            }
+        }
+
+        if (report.rowsImported > 0) saveData();
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+private:
+    // Splits one catalog row into named fields. Returns false with an empty
+    // error for a CSV header row, or with a message for a malformed row.
+    static bool parseCatalogRow(const string& line, map<string, string>& fields, string& error) {
+        size_t start = line.find_first_not_of(" \t");
+        if (line[start] == '{') {
+            // Flat JSON object: "key": "string" or "key": number
+            size_t pos = start + 1;
+            while (true) {
+                size_t keyStart = line.find('"', pos);
+                if (keyStart == string::npos) break;
+                size_t keyEnd = line.find('"', keyStart + 1);
+                size_t colon = keyEnd == string::npos ? string::npos : line.find(':', keyEnd);
+                if (colon == string::npos) {
+                    error = "malformed JSON object";
+                    return false;
+                }
+                string key = line.substr(keyStart + 1, keyEnd - keyStart - 1);
+                size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+                if (valueStart == string::npos) {
+                    error = "missing value for '" + key + "'";
+                    return false;
+                }
+                string value;
+                if (line[valueStart] == '"') {
+                    size_t i = valueStart + 1;
+                    while (i < line.size() && line[i] != '"') {
+                        if (line[i] == '\\' && i + 1 < line.size()) i++;
+                        value += line[i++];
+                    }
+                    if (i >= line.size()) {
+                        error = "unterminated string for '" + key + "'";
+                        return false;
+                    }
+                    pos = i + 1;
+                } else {
+                    size_t valueEnd = line.find_first_of(",}", valueStart);
+                    if (valueEnd == string::npos) valueEnd = line.size();
+                    value = line.substr(valueStart, valueEnd - valueStart);
+                    while (!value.empty() && isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+                    pos = valueEnd;
+                }
+                fields[key] = value;
+            }
+            return true;
+        }
+
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(line);
+        while (getline(tokenStream, token, ',')) {
+            tokens.push_back(token);
+        }
+        if (tokens.size() != 5 && tokens.size() != 6) {
+            error = "expected 5 or 6 columns (title,genre,price,date,time[,hall]), found " + to_string(tokens.size());
+            return false;
+        }
+        string firstColumn = tokens[0];
+        transform(firstColumn.begin(), firstColumn.end(), firstColumn.begin(), ::tolower);
+        if (firstColumn == "title") return false;
+
+        fields["title"] = tokens[0];
+        fields["genre"] = tokens[1];
+        fields["price"] = tokens[2];
+        fields["date"] = tokens[3];
+        fields["time"] = tokens[4];
+        if (tokens.size() == 6) fields["hall"] = tokens[5];
+        return true;
+    }
+};
+
+// Initialize static member
+CinemaBookingSystem* CinemaBookingSystem::instance = nullptr;
+
+// Result codes of the BookingEngine calls
+enum EngineStatus {
+    ENGINE_OK = 0,
+    ENGINE_NOT_FOUND,     // no such movie, showtime or booking
+    ENGINE_INVALID,       // malformed argument or seat outside the hall
+    ENGINE_SEAT_TAKEN,    // a requested seat is already booked
+    ENGINE_SOLD_OUT,
+    ENGINE_EXISTS,        // showtime is already scheduled
+    ENGINE_CONFLICT       // the booking changed in another instance meanwhile
+};
+
+const char* engineStatusText(EngineStatus status) {
+    switch (status) {
+        case ENGINE_OK: return "OK";
+        case ENGINE_NOT_FOUND: return "not found";
+        case ENGINE_INVALID: return "invalid request";
+        case ENGINE_SEAT_TAKEN: return "seat already booked";
+        case ENGINE_SOLD_OUT: return "sold out";
+        case ENGINE_EXISTS: return "already scheduled";
+        case ENGINE_CONFLICT: return "changed at another counter";
+    }
+    return "unknown";
+}
+
+// Non-interactive booking operations. Every call takes plain arguments,
+// validates them, commits through CinemaBookingSystem and returns a status;
+// nothing here reads input or prints. The menu flows and the booking server
+// are clients of this class.
+class BookingEngine {
+public:
+    // CinemaBookingSystem is single-threaded, while menu flows run on several
+    // SessionLoop threads. Every call below holds the turn while it runs, and
+    // a flow that reads the system directly holds one between two of its
+    // suspensions, never across one.
+    class Turn {
+    public:
+        Turn() : lock(turnMutex()) {}
+
+    private:
+        static recursive_mutex& turnMutex() {
+            static recursive_mutex mutex;
+            return mutex;
+        }
+        lock_guard<recursive_mutex> lock;
+    };
+
+    // Runs read under a turn and returns its result
+    template <typename Read>
+    static auto withTurn(Read read) {
+        Turn turn;
+        return read();
+    }
+
+    struct BookResult {
+        EngineStatus status = ENGINE_OK;
+        vector<int> bookingIDs; // one per seat, in request order
+        double total = 0.0;
+        string seat;            // the seat that failed, if any
+    };
+
+    struct SalesReport {
+        struct MovieSales {
+            int movieID;
+            string title;
+            int tickets;
+            double revenue;
+        };
+        vector<MovieSales> movies; // movies with at least one ticket, catalog order
+        int tickets = 0;
+        double revenue = 0.0;
+    };
+
+    struct RecurringResult {
+        EngineStatus status = ENGINE_OK;
+        int added = 0;
+        int skipped = 0; // showtimes the movie already had
+    };
+
+    struct BulkResult {
+        EngineStatus status = ENGINE_OK;
+        vector<Booking> cancelled;
+        vector<pair<Booking, Booking>> moved; // before, after
+    };
+
+    struct MoviePage {
+        vector<Movie> movies; // this page, title order
+        size_t total = 0;     // matches over all pages
+    };
+
+    explicit BookingEngine(CinemaBookingSystem& bookingSystem) : system(bookingSystem) {}
+
+    // Books seats (e.g. {"A1", "A2"}) for one showtime ("YYYY-MM-DD HH:MM"),
+    // all or nothing, at the movie's current price
+    BookResult book(const string& username, int movieID, const string& showtime, const vector<string>& seats,
+                    const string& paymentMode) {
+        Turn turn;
+        BookResult result;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        const Movie* movie = findMovie(*view, movieID);
+        if (!movie) return fail(result, ENGINE_NOT_FOUND);
+        if (seats.empty() || !isPlainField(username) || !isPlainField(paymentMode)) return fail(result, ENGINE_INVALID);
+        if (!hasShowtime(*movie, showtime)) return fail(result, ENGINE_NOT_FOUND);
+        if (system.remainingSeats(movieID, showtime) == 0) return fail(result, ENGINE_SOLD_OUT);
+
+        vector<Booking> batch;
+        for (const auto& seat : seats) {
+            result.seat = seat;
+            if (!system.seatExists(movieID, showtime, seat)) return fail(result, ENGINE_INVALID);
+            if (!system.isSeatAvailable(movieID, showtime, seat)) return fail(result, ENGINE_SEAT_TAKEN);
+            batch.emplace_back(username, movieID, scheduleOf(showtime), seat, movie->getPrice(), paymentMode);
+        }
+        result.seat.clear();
+        // Also refuses a seat listed twice or sold by another instance meanwhile
+        if (!system.addBookings(batch)) return fail(result, ENGINE_SEAT_TAKEN);
+        for (const auto& booking : batch) {
+            result.bookingIDs.push_back(booking.getBookingID());
+            result.total += booking.getPrice();
+        }
+        return result;
+    }
+
+    EngineStatus cancel(int bookingID) {
+        Turn turn;
+        int index = system.findBookingByID(bookingID);
+        if (index < 0) return ENGINE_NOT_FOUND;
+        return system.removeBooking(index) ? ENGINE_OK : ENGINE_CONFLICT;
+    }
+
+    // Moves a booking to another showtime of the same movie and/or another
+    // seat. An empty seat keeps the current one, an empty payment mode keeps
+    // the current mode; the price becomes the movie's current price.
+    EngineStatus reschedule(int bookingID, const string& showtime, string seat, string paymentMode) {
+        Turn turn;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        auto found = find_if(view->bookings.begin(), view->bookings.end(),
+                             [&](const Booking& b) { return b.getBookingID() == bookingID; });
+        int index = system.findBookingByID(bookingID);
+        if (found == view->bookings.end() || index < 0) return ENGINE_NOT_FOUND;
+        const Booking ticket = *found;
+        const Movie* movie = findMovie(*view, ticket.getMovieID());
+        if (!movie || !hasShowtime(*movie, showtime)) return ENGINE_NOT_FOUND;
+        if (seat.empty()) seat = ticket.getSeat();
+        if (paymentMode.empty()) paymentMode = ticket.getPaymentMode();
+        if (!isPlainField(paymentMode) || !system.seatExists(movie->getMovieID(), showtime, seat)) return ENGINE_INVALID;
+
+        bool sameSeat = showtime == ticket.getSchedule().getFullSchedule() && seat == ticket.getSeat();
+        if (!sameSeat && !system.isSeatAvailable(movie->getMovieID(), showtime, seat)) return ENGINE_SEAT_TAKEN;
+        return system.updateBooking(index, scheduleOf(showtime), seat, movie->getPrice(), paymentMode) ? ENGINE_OK
+                                                                                                          : ENGINE_CONFLICT;
+    }
+
+    // Schedules a movie in a hall and creates its empty seat map
+    EngineStatus addShowtime(int movieID, const string& showtime, const string& hallName = DEFAULT_HALL) {
+        Turn turn;
+        if (!isValidShowtime(showtime) || !system.getHalls().count(hallName)) return ENGINE_INVALID;
+        vector<Movie>& movies = system.getMovies();
+        auto movie = find_if(movies.begin(), movies.end(), [&](const Movie& m) { return m.getMovieID() == movieID; });
+        if (movie == movies.end() || system.isRetired(movieID)) return ENGINE_NOT_FOUND;
+        if (hasShowtime(*movie, showtime)) return ENGINE_EXISTS;
+        system.reviveShowtime(movieID, showtime);
+        movie->addSchedule(scheduleOf(showtime));
+        system.initializeSeatsForNewMovie(movieID, showtime, hallName);
+        system.saveData();
+        return ENGINE_OK;
+    }
+
+    // Schedules a movie at each of times ("HH:MM") on every day, or every
+    // Monday to Friday, from fromDate to toDate inclusive (at most a year),
+    // in one batch. Showtimes already scheduled are counted as skipped.
+    RecurringResult addRecurringShowtimes(int movieID, const string& fromDate, const string& toDate,
+                                          const vector<string>& times, bool weekdaysOnly,
+                                          const string& hallName = DEFAULT_HALL) {
+        Turn turn;
+        RecurringResult result;
+        set<string> slots(times.begin(), times.end());
+        bool valid = isValidDate(fromDate) && isValidDate(toDate) && fromDate <= toDate && !slots.empty() &&
+                     system.getHalls().count(hallName);
+        for (const auto& time : slots) valid = valid && isValidTime(time);
+        if (!valid) return fail(result, ENGINE_INVALID);
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        const Movie* movie = findMovie(*view, movieID);
+        if (!movie) return fail(result, ENGINE_NOT_FOUND);
+
+        vector<string> showtimes;
+        for (int offset = 0;; offset++) {
+            tm day = noonOf(fromDate, offset);
+            string date = formatDate(day);
+            if (date > toDate) break;
+            if (offset > 366) return fail(result, ENGINE_INVALID);
+            if (weekdaysOnly && (day.tm_wday == 0 || day.tm_wday == 6)) continue;
+            for (const auto& time : slots) {
+                string showtime = date + " " + time;
+                if (hasShowtime(*movie, showtime)) result.skipped++;
+                else showtimes.push_back(showtime);
+            }
+        }
+        result.added = system.addShowtimes(movieID, showtimes, hallName);
+        result.skipped += showtimes.size() - result.added;
+        return result;
+    }
+
+    // Cancels every booking of a showtime in one commit
+    BulkResult cancelShowtime(int movieID, const string& showtime) {
+        Turn turn;
+        BulkResult result;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        const Movie* movie = findMovie(*view, movieID);
+        if (!movie || !hasShowtime(*movie, showtime)) return fail(result, ENGINE_NOT_FOUND);
+        system.cancelShowtimeBookings(movieID, showtime, result.cancelled);
+        return result;
+    }
+
+    // Moves every booking of a showtime to another showtime of the same
+    // movie in one commit; refused as sold out unless all of them fit
+    BulkResult moveShowtime(int movieID, const string& fromShowtime, const string& toShowtime) {
+        Turn turn;
+        BulkResult result;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        const Movie* movie = findMovie(*view, movieID);
+        if (!movie || !hasShowtime(*movie, fromShowtime) || !hasShowtime(*movie, toShowtime)) {
+            return fail(result, ENGINE_NOT_FOUND);
+        }
+        if (fromShowtime == toShowtime) return fail(result, ENGINE_INVALID);
+        int affected = count_if(view->bookings.begin(), view->bookings.end(), [&](const Booking& b) {
+            return b.getMovieID() == movieID && b.getSchedule().getFullSchedule() == fromShowtime;
+        });
+        EngineStatus status = moveRefusal(movieID, toShowtime, affected);
+        if (status != ENGINE_OK) return fail(result, status);
+        if (!system.moveShowtimeBookings(movieID, fromShowtime, toShowtime, result.moved)) {
+            // Nothing moved: the target changed since the checks above
+            status = result.moved.empty() ? moveRefusal(movieID, toShowtime, affected) : ENGINE_CONFLICT;
+            return fail(result, status == ENGINE_OK ? ENGINE_CONFLICT : status);
+        }
+        return result;
+    }
+
+    // Tickets and revenue per movie over the live bookings
+    SalesReport report() const {
+        Turn turn;
+        TraceSpan span("salesReport", "report");
+        SalesReport sales;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        map<int, pair<int, double>> movieStats;
+        for (const auto& booking : view->bookings) {
+            movieStats[booking.getMovieID()].first++;
+            movieStats[booking.getMovieID()].second += booking.getPrice();
+            sales.tickets++;
+            sales.revenue += booking.getPrice();
+        }
+        for (const auto& movie : view->movies) {
+            auto it = movieStats.find(movie.getMovieID());
+            if (it != movieStats.end()) {
+                sales.movies.push_back({movie.getMovieID(), movie.getTitle(), it->second.first, it->second.second});
+            }
+        }
+        return sales;
+    }
+
+    // One page (counting from 0) of the movies with a title word starting
+    // with titlePrefix and, if genre is not empty, of that genre
+    MoviePage searchMovies(const string& titlePrefix, const string& genre, size_t page, size_t pageSize) {
+        Turn turn;
+        MoviePage result;
+        shared_ptr<const BookingSnapshot> view = system.snapshot();
+        vector<int> matches = system.catalogIndex()->search(titlePrefix, genre);
+        result.total = matches.size();
+        for (size_t i = page * pageSize; i < matches.size() && i < (page + 1) * pageSize; i++) {
+            if (const Movie* movie = findMovie(*view, matches[i])) result.movies.push_back(*movie);
+        }
+        return result;
+    }
+
+private:
+    CinemaBookingSystem& system;
+
+    template <typename Result>
+    static Result& fail(Result& result, EngineStatus status) {
+        result.status = status;
+        return result;
+    }
+
+    static const Movie* findMovie(const BookingSnapshot& view, int movieID) {
+        for (const auto& movie : view.movies) {
+            if (movie.getMovieID() == movieID) return &movie;
+        }
+        return nullptr;
+    }
+
+    static bool hasShowtime(const Movie& movie, const string& showtime) {
+        for (const auto& schedule : movie.getSchedules()) {
+            if (schedule.getFullSchedule() == showtime) return true;
+        }
+        return false;
+    }
+
+    // Why `count` bookings cannot move to the target showtime right now, or
+    // ENGINE_OK if they fit
+    EngineStatus moveRefusal(int movieID, const string& toShowtime, int count) const {
+        int remaining = system.remainingSeats(movieID, toShowtime);
+        if (remaining < 0 || !system.isBookable(movieID, toShowtime)) return ENGINE_NOT_FOUND;
+        return remaining < count ? ENGINE_SOLD_OUT : ENGINE_OK;
+    }
+
+    // Values stored in the comma-separated data files
+    static bool isPlainField(const string& value) {
+        return !value.empty() && value.find_first_of(",\n\r") == string::npos;
+    }
+
+    static Schedule scheduleOf(const string& showtime) {
+        return Schedule(showtime.substr(0, 10), showtime.substr(11));
+    }
+};
+
+// Seat prompt offering the best free seat, if any, on Enter
+string seatPrompt(const vector<string>& suggested) {
+    string prompt = "Enter seat (e.g., A1)";
+    if (!suggested.empty()) prompt += ", Enter for the suggested seat " + suggested[0];
+    return prompt + ", or '0' to cancel: ";
+}
+
+// Search input of the movie pickers: "g:<genre>" looks up a genre, anything
+// else is a title prefix
+void parseMovieSearch(const string& input, string& titlePrefix, string& genre) {
+    titlePrefix = genre = "";
+    if (input.rfind("g:", 0) == 0 || input.rfind("G:", 0) == 0) genre = input.substr(2);
+    else titlePrefix = input;
+}
+
+// Prints one page of matches and the choices after it. With no matches it
+// says so, listing the genres after a genre search, and returns false.
+bool showMoviePage(ostream& out, const BookingEngine::MoviePage& result, bool byGenre, size_t page, size_t pageSize) {
+    if (result.total == 0) {
+        out << RED << "No movies match." << RESET << endl;
+        if (byGenre) {
+            out << "Genres:";
+            for (const auto& name : CinemaBookingSystem::getInstance()->catalogIndex()->genres()) out << " " << name;
+            out << endl;
+        }
+        return false;
+    }
+    size_t pages = (result.total + pageSize - 1) / pageSize;
+    out << "\n" << result.total << " movie(s), page " << page + 1 << " of " << pages << endl;
+    for (size_t i = 0; i < result.movies.size(); i++) {
+        const Movie& movie = result.movies[i];
+        out << setw(3) << i + 1 << ". " << YELLOW << left << setw(28) << movie.getTitle() << RESET << setw(20)
+            << movie.getGenre() << right << "₱" << fixed << setprecision(2) << movie.getPrice() << "  "
+            << movie.getSchedules().size() << " showtime(s)" << endl;
+    }
+    out << "Enter number to select";
+    if (page + 1 < pages) out << ", 'n' next page";
+    if (page > 0) out << ", 'p' previous page";
+    out << ", 's' new search, '0' to cancel: ";
+    return true;
+}
+
+#ifdef __cpp_impl_coroutine
+// The menus are C++20 coroutines rather than blocking cin loops, so an
+// interactive user does not need a thread of their own: a Session suspends
+// whenever it needs a line of input and is resumed by a SessionLoop once one
+// has arrived, so a few loop threads can interleave thousands of sessions.
+// Whatever feeds a session (a replay script, the terminal in runConsole, a
+// socket later) only has to call feed() and close(). Sessions run in
+// parallel and take a BookingEngine::Turn only to read or commit.
+
+// Thrown inside a flow when its input is closed while it waits for a line
+struct SessionEnded {};
+
+template <typename T>
+struct TaskResult {
+    optional<T> value;
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(*value); }
+};
+
+template <>
+struct TaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+// Lazily started coroutine. Awaiting a Task runs it; the awaiting coroutine
+// continues when it finishes and receives its result (or what it threw).
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : TaskResult<T> {
+        coroutine_handle<> continuation;
+        exception_ptr error;
+
+        Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+        suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct ResumeAwaiting {
+                bool await_ready() noexcept { return false; }
+                coroutine_handle<> await_suspend(coroutine_handle<promise_type> finished) noexcept {
+                    coroutine_handle<> next = finished.promise().continuation;
+                    return next ? next : noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return ResumeAwaiting{};
+        }
+        void unhandled_exception() { error = current_exception(); }
+    };
+
+    Task() = default;
+    Task(Task&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) rethrow_exception(handle.promise().error);
+        return handle.promise().take();
+    }
+
+    // For a top-level task that nothing awaits
+    void start() { handle.resume(); }
+    bool done() const { return !handle || handle.done(); }
+    exception_ptr error() const { return handle ? handle.promise().error : nullptr; }
+
+private:
+    coroutine_handle<promise_type> handle = nullptr;
+    explicit Task(coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+// One interactive user: queued input lines, the transcript written so far and
+// the coroutine currently waiting for the next line. Only one thread resumes
+// a session, but any thread may feed or close it.
+class Session {
+private:
+    ostream* terminal = nullptr; // the console, which echoes input itself
+    ostringstream transcript;
+    mutable mutex inputMutex;    // guards input, closed and waiting
+    deque<string> input;
+    bool closed = false;
+    bool started = false;
+    coroutine_handle<> waiting;
+    Task<> flow;
+
+public:
+    Session() = default;
+    // A session on the console writes straight to it instead of a transcript
+    explicit Session(ostream& console) : terminal(&console) {}
+
+    void attach(Task<> task) { flow = std::move(task); }
+    ostream& out() { return terminal ? *terminal : transcript; }
+
+    void feed(const string& line) {
+        lock_guard<mutex> lock(inputMutex);
+        input.push_back(line);
+    }
+
+    void close() {
+        lock_guard<mutex> lock(inputMutex);
+        closed = true;
+    }
+
+    bool finished() const { return flow.done(); }
+    // Suspended on a line that has not been fed yet
+    bool idle() const {
+        lock_guard<mutex> lock(inputMutex);
+        return waiting && input.empty() && !closed;
+    }
+    // resume() would run it: not started yet, or its line (or the close) is in
+    bool ready() const {
+        lock_guard<mutex> lock(inputMutex);
+        return !flow.done() && (!started || (waiting && (!input.empty() || closed)));
+    }
+    exception_ptr error() const { return flow.error(); }
+
+    // Runs the flow until it needs input it does not have yet
+    void resume() {
+        coroutine_handle<> next;
+        {
+            lock_guard<mutex> lock(inputMutex);
+            if (!started) {
+                started = true;
+            } else if (waiting && (!input.empty() || closed)) {
+                next = exchange(waiting, nullptr);
+            } else {
+                return;
+            }
+        }
+        if (next) next.resume();
+        else flow.start();
+    }
+
+    string takeOutput() {
+        string text = transcript.str();
+        transcript.str("");
+        return text;
+    }
+
+    // co_await session.readLine() yields the next line, echoed into the
+    // transcript like a terminal would, or nullopt once input is closed
+    auto readLine() {
+        struct LineAwaiter {
+            Session& session;
+            bool await_ready() const {
+                lock_guard<mutex> lock(session.inputMutex);
+                return !session.input.empty() || session.closed;
+            }
+            void await_suspend(coroutine_handle<> awaiting) {
+                lock_guard<mutex> lock(session.inputMutex);
+                session.waiting = awaiting;
+            }
+            optional<string> await_resume() {
+                optional<string> line;
+                {
+                    lock_guard<mutex> lock(session.inputMutex);
+                    if (session.input.empty()) return nullopt;
+                    line = std::move(session.input.front());
+                    session.input.pop_front();
+                }
+                if (!session.terminal) session.transcript << *line << "\n";
+                return line;
+            }
+        };
+        return LineAwaiter{*this};
+    }
+};
+
+// Prompts of the flows below. Arguments are taken by value because they must
+// outlive every suspension.
+Task<string> ask(Session& session, string prompt) {
+    session.out() << prompt;
+    optional<string> line = co_await session.readLine();
+    if (!line) throw SessionEnded();
+    co_return *line;
+}
+
+// Like cin >> would, skips blank lines
+Task<string> askWord(Session& session, string prompt) {
+    string line = co_await ask(session, prompt);
+    while (line.find_first_not_of(" \t\r") == string::npos) line = co_await ask(session, "");
+    co_return line;
+}
+
+Task<int> askChoice(Session& session, int min, int max) {
+    while (true) {
+        string line = co_await askWord(session, CYAN + "\n  Enter your choice (" + to_string(min) + "-" + to_string(max) + "): " + RESET);
+        istringstream parse(line);
+        int choice;
+        if (parse >> choice && choice >= min && choice <= max) co_return choice;
+        session.out() << RED << "\n  Invalid input. Please try again." << RESET << endl;
+    }
+}
+
+Task<bool> askConfirmation(Session& session, string prompt) {
+    while (true) {
+        string line = co_await askWord(session, YELLOW + "\n  " + prompt + " (Y/N): " + RESET);
+        char confirm = toupper(line[line.find_first_not_of(" \t")]);
+        if (confirm == 'Y') co_return true;
+        if (confirm == 'N') co_return false;
+        session.out() << RED << "\n  Invalid input. Please enter Y or N." << RESET << endl;
+    }
+}
+
+Task<string> askPaymentMode(Session& session) {
+    session.out() << "\nSelect Payment Mode:" << endl;
+    session.out() << "1. Cash" << endl;
+    session.out() << "2. Credit/Debit Card" << endl;
+    session.out() << "3. GCash" << endl;
+    static const string modes[] = {"Cash", "Credit/Debit Card", "GCash"};
+    int choice = co_await askChoice(session, 1, 3);
+    co_return modes[choice - 1];
+}
+
+// Empty if the customer cancels with '0'
+Task<string> askSeat(Session& session, int movieID, string showtime) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    while (true) {
+        vector<string> suggested = BookingEngine::withTurn([&] { return system->recommendSeats(movieID, showtime); });
+        string seat = co_await ask(session, seatPrompt(suggested));
+        transform(seat.begin(), seat.end(), seat.begin(), ::toupper);
+        if (seat.empty() && !suggested.empty()) seat = suggested[0];
+        if (seat == "0") co_return "";
+        if (BookingEngine::withTurn([&] { return system->isSeatAvailable(movieID, showtime, seat); })) co_return seat;
+        session.out() << "Invalid or already booked seat. Please try again." << endl;
+    }
+}
+
+// Finds a movie by title or genre and pages through the matches instead of
+// printing the whole catalog. The movie is a copy taken from the search, so
+// it stays valid across suspensions. Empty if the user cancels.
+Task<optional<Movie>> askMovie(Session& session, string heading) {
+    const size_t pageSize = 10;
+    BookingEngine engine(*CinemaBookingSystem::getInstance());
+    ostream& out = session.out();
+    string titlePrefix, genre;
+    size_t page = 0;
+    bool searching = true;
+
+    while (true) {
+        if (searching) {
+            out << "\n=== " << heading << " ===" << endl;
+            string input = co_await ask(session, "Search by title, 'g:<genre>' for a genre, Enter for all, or '0' to cancel: ");
+            if (input == "0") co_return nullopt;
+            parseMovieSearch(input, titlePrefix, genre);
+            page = 0;
+            searching = false;
+        }
+
+        BookingEngine::MoviePage result = engine.searchMovies(titlePrefix, genre, page, pageSize);
+        if (!showMoviePage(out, result, !genre.empty(), page, pageSize)) {
+            searching = true;
+            continue;
+        }
+        size_t pages = (result.total + pageSize - 1) / pageSize;
+        string input = co_await ask(session, "");
+
+        if (input == "0") co_return nullopt;
+        if ((input == "n" || input == "N") && page + 1 < pages) {
+            page++;
+        } else if ((input == "p" || input == "P") && page > 0) {
+            page--;
+        } else if (input == "s" || input == "S") {
+            searching = true;
+        } else {
+            size_t choice = 0;
+            try {
+                choice = stoul(input);
+            } catch (...) {
+            }
+            if (choice >= 1 && choice <= result.movies.size()) co_return result.movies[choice - 1];
+            out << RED << "Invalid input. Please try again." << RESET << endl;
+        }
+    }
+}
+
+// Numbered showtimes of a movie with the seats left in each
+void showSchedules(ostream& out, const Movie& movie) {
+    BookingEngine::Turn turn;
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    const vector<Schedule>& schedules = movie.getSchedules();
+    for (size_t i = 0; i < schedules.size(); i++) {
+        out << i+1 << ". ";
+        schedules[i].display(out);
+        out << "  " << system->availabilityLabel(movie.getMovieID(), schedules[i].getFullSchedule()) << endl;
+    }
+}
+
+// Flows read movies and bookings from a snapshot, which stays valid across
+// suspensions; the engine is only touched between them, under a turn.
+Task<> bookFlow(Session& session, string username) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    if (BookingEngine(*system).searchMovies("", "", 0, 0).total == 0) {
+        out << "No movies available for booking." << endl;
+        co_return;
+    }
+
+    optional<Movie> picked = co_await askMovie(session, "Book a Ticket");
+    if (!picked) {
+        out << "Booking cancelled." << endl;
+        co_return;
+    }
+
+    const Movie& selectedMovie = *picked;
+    const vector<Schedule>& schedules = selectedMovie.getSchedules();
+    if (schedules.empty()) {
+        out << "No schedules available for this movie." << endl;
+        co_return;
+    }
+
+    out << "\nAvailable schedules for " << selectedMovie.getTitle() << ":" << endl;
+    showSchedules(out, selectedMovie);
+
+    out << "Enter schedule number (0 to cancel): ";
+    int scheduleChoice = co_await askChoice(session, 0, schedules.size());
+    if (scheduleChoice == 0) {
+        out << "Booking cancelled." << endl;
+        co_return;
+    }
+
+    Schedule selectedSchedule = schedules[scheduleChoice - 1];
+    {
+        BookingEngine::Turn turn;
+        if (system->remainingSeats(selectedMovie.getMovieID(), selectedSchedule.getFullSchedule()) == 0) {
+            out << "Sorry, this showtime is sold out." << endl;
+            co_return;
+        }
+        out << "\n\t\t=== THEATER LAYOUT ===" << endl;
+        system->displaySeatLayout(selectedMovie.getMovieID(), selectedSchedule.getFullSchedule(), out);
+    }
+
+    string seat = co_await askSeat(session, selectedMovie.getMovieID(), selectedSchedule.getFullSchedule());
+    if (seat.empty()) {
+        out << "Booking cancelled." << endl;
+        co_return;
+    }
+
+    out << "\n\tYou have selected: " << seat << endl;
+    out << "\tPrice: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
+    out << "\t----------------------------" << endl;
+
+    out << "\n=== Booking Summary ===" << endl;
+    out << "Movie: " << selectedMovie.getTitle() << endl;
+    out << "Date: " << selectedSchedule.getDate() << endl;
+    out << "Time: " << selectedSchedule.getTime() << endl;
+    out << "Seat: " << seat << endl;
+    out << "Price: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
+
+    bool confirmed = co_await askConfirmation(session, "Confirm booking details?");
+    if (!confirmed) {
+        out << "Booking cancelled." << endl;
+        co_return;
+    }
+    string paymentMode = co_await askPaymentMode(session);
+    out << "\nPayment Summary:" << endl;
+    out << "Amount to Pay: ₱" << fixed << setprecision(2) << selectedMovie.getPrice() << endl;
+    out << "Payment Mode: " << paymentMode << endl;
+
+    bool paid = co_await askConfirmation(session, "Confirm payment?");
+    if (!paid) {
+        out << "Payment cancelled. Booking not confirmed." << endl;
+        co_return;
+    }
+    BookingEngine::BookResult result = BookingEngine(*system).book(username, selectedMovie.getMovieID(),
+                                                                   selectedSchedule.getFullSchedule(), {seat}, paymentMode);
+    if (result.status == ENGINE_SEAT_TAKEN) {
+        out << RED << "\nSorry, seat " << seat << " was just booked at another counter. Please choose another seat." << RESET << endl;
+        co_return;
+    }
+    if (result.status != ENGINE_OK) {
+        out << RED << "\nBooking failed: " << engineStatusText(result.status) << "." << RESET << endl;
+        co_return;
+    }
+    out << "\n\t*********************************" << endl;
+    out << "\t*                               *" << endl;
+    out << "\t*      BOOKING CONFIRMED!       *" << endl;
+    out << "\t*                               *" << endl;
+    out << "\t*********************************" << endl;
+    out << "\nPayment of ₱" << fixed << setprecision(2) << selectedMovie.getPrice()
+        << " via " << paymentMode << " has been processed." << endl;
+}
+
+// Lists the customer's bookings and returns them in display order
+vector<Booking> listOwnBookings(ostream& out, const BookingSnapshot& view, const string& username, bool numbered) {
+    vector<Booking> own = CinemaBookingSystem::getInstance()->bookingsOf(username);
+    for (size_t i = 0; i < own.size(); i++) {
+        if (numbered) out << i + 1 << ".";
+        own[i].displayDetails(view.movies, out);
+    }
+    return own;
+}
+
+Task<> editFlow(Session& session, string username) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    shared_ptr<const BookingSnapshot> view = system->snapshot();
+    ostream& out = session.out();
+
+    out << "\n=== My Bookings ===" << endl;
+    vector<Booking> own = listOwnBookings(out, *view, username, true);
+    if (own.empty()) {
+        out << "You have no bookings to edit." << endl;
+        co_return;
+    }
+
+    out << "Enter booking number to edit (0 to cancel): ";
+    int bookingChoice = co_await askChoice(session, 0, own.size());
+    if (bookingChoice == 0) {
+        out << "Edit cancelled." << endl;
+        co_return;
+    }
+    const Booking ticket = own[bookingChoice - 1];
+
+    auto movie = find_if(view->movies.begin(), view->movies.end(),
+                         [&](const Movie& m) { return m.getMovieID() == ticket.getMovieID(); });
+    if (movie == view->movies.end()) {
+        out << "Error: Movie not found." << endl;
+        co_return;
+    }
+
+    const vector<Schedule>& schedules = movie->getSchedules();
+    out << "\nAvailable schedules for " << movie->getTitle() << ":" << endl;
+    showSchedules(out, *movie);
+
+    out << "Enter new schedule number (0 to keep current): ";
+    int scheduleChoice = co_await askChoice(session, 0, schedules.size());
+    Schedule newSchedule = ticket.getSchedule();
+    if (scheduleChoice > 0) {
+        newSchedule = schedules[scheduleChoice - 1];
+        if (newSchedule.getFullSchedule() != ticket.getSchedule().getFullSchedule() &&
+            BookingEngine::withTurn([&] { return system->remainingSeats(movie->getMovieID(), newSchedule.getFullSchedule()); }) == 0) {
+            out << "Sorry, that showtime is sold out. Keeping your current schedule." << endl;
+            newSchedule = ticket.getSchedule();
+        }
+    }
+
+    {
+        BookingEngine::Turn turn;
+        system->displaySeatLayout(movie->getMovieID(), newSchedule.getFullSchedule(), out);
+    }
+    out << "Enter new seat (current: " << ticket.getSeat() << ", enter 0 to keep current): ";
+    string newSeat = co_await askSeat(session, movie->getMovieID(), newSchedule.getFullSchedule());
+    if (newSeat.empty()) newSeat = ticket.getSeat();
+
+    out << "\n=== Updated Booking Summary ===" << endl;
+    out << "Movie: " << movie->getTitle() << endl;
+    out << "Date: " << newSchedule.getDate() << endl;
+    out << "Time: " << newSchedule.getTime() << endl;
+    out << "Seat: " << newSeat << endl;
+    out << "Price: ₱" << fixed << setprecision(2) << movie->getPrice() << endl;
+    out << "Current Payment Mode: " << ticket.getPaymentMode() << endl;
+
+    string newPaymentMode = ticket.getPaymentMode();
+    bool changePayment = co_await askConfirmation(session, "Would you like to change the payment mode?");
+    if (changePayment) {
+        newPaymentMode = co_await askPaymentMode(session);
+    }
+
+    out << "\nFinal Payment Summary:" << endl;
+    out << "Amount to Pay: ₱" << fixed << setprecision(2) << movie->getPrice() << endl;
+    out << "Payment Mode: " << newPaymentMode << endl;
+
+    bool confirmed = co_await askConfirmation(session, "Confirm changes?");
+    if (!confirmed) {
+        out << "Edit cancelled." << endl;
+        co_return;
+    }
+    EngineStatus status = BookingEngine(*system).reschedule(ticket.getBookingID(), newSchedule.getFullSchedule(), newSeat, newPaymentMode);
+    if (status != ENGINE_OK) {
+        out << RED << "Sorry, the booking could not be changed: " << engineStatusText(status) << ". Nothing was updated." << RESET << endl;
+        co_return;
+    }
+    out << "Booking updated successfully!" << endl;
+    if (newPaymentMode != ticket.getPaymentMode()) {
+        out << "Payment mode has been updated to: " << newPaymentMode << endl;
+    }
+}
+
+Task<> cancelFlow(Session& session, string username) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    shared_ptr<const BookingSnapshot> view = system->snapshot();
+    ostream& out = session.out();
+
+    out << "\n=== My Bookings ===" << endl;
+    vector<Booking> own = listOwnBookings(out, *view, username, true);
+    if (own.empty()) {
+        out << "You have no bookings to cancel." << endl;
+        co_return;
+    }
+
+    out << "Enter booking number to cancel (0 to cancel): ";
+    int bookingChoice = co_await askChoice(session, 0, own.size());
+    bool confirmed = bookingChoice > 0;
+    if (confirmed) confirmed = co_await askConfirmation(session, "Are you sure you want to cancel this booking?");
+    if (!confirmed) {
+        out << "Cancellation aborted." << endl;
+        co_return;
+    }
+    if (BookingEngine(*system).cancel(own[bookingChoice - 1].getBookingID()) == ENGINE_OK) {
+        out << "Booking cancelled successfully." << endl;
+    } else {
+        out << "This booking was already cancelled at another counter." << endl;
+    }
+}
+
+Task<> customerFlow(Session& session, string username) {
+    ostream& out = session.out();
+    while (true) {
+        out << "\n\n\t╔═══════════════════════════════════╗" << endl;
+        out << "\t║          Customer Menu            ║" << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
+        out << "\t║  1. Book Ticket                   ║" << endl;
+        out << "\t║  2. View My Bookings              ║" << endl;
+        out << "\t║  3. Edit Booking                  ║" << endl;
+        out << "\t║  4. Cancel Booking                ║" << endl;
+        out << "\t║  5. Logout                        ║" << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
+
+        int choice = co_await askChoice(session, 1, 5);
+        if (choice < 5) out << "\n";
+        switch (choice) {
+            case 1:
+                co_await bookFlow(session, username);
+                break;
+            case 2: {
+                CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+                shared_ptr<const BookingSnapshot> view = system->snapshot();
+                out << "\n=== My Bookings ===" << endl;
+                bool hasBookings = !listOwnBookings(out, *view, username, false).empty();
+                vector<Booking> past = BookingEngine::withTurn([&] { return system->archivedBookingsOf(username); });
+                if (!past.empty()) {
+                    out << "\n=== Past Bookings ===" << endl;
+                    for (const auto& booking : past) booking.displayDetails(view->movies, out);
+                }
+                if (!hasBookings && past.empty()) out << "You have no bookings." << endl;
+                break;
+            }
+            case 3:
+                co_await editFlow(session, username);
+                break;
+            case 4:
+                co_await cancelFlow(session, username);
+                break;
+            case 5:
+                out << "\n\t╔═══════════════════════════════════╗" << endl;
+                out << YELLOW << "\t║          Logging out...           ║" << RESET << endl;
+                out << "\t╚═══════════════════════════════════╝" << endl;
+                out << "\n";
+                co_return;
+        }
+    }
+}
+
+// Prompts for a valid date and time
+Task<Schedule> askSchedule(Session& session) {
+    while (true) {
+        string date = co_await ask(session, "Enter date (YYYY-MM-DD): ");
+        if (!isValidDate(date)) {
+            session.out() << "Invalid date format. Please use YYYY-MM-DD." << endl;
+            continue;
+        }
+        string time = co_await ask(session, "Enter time (HH:MM): ");
+        if (!isValidTime(time)) {
+            session.out() << "Invalid time format. Please use HH:MM." << endl;
+            continue;
+        }
+        co_return Schedule(date, time);
+    }
+}
+
+// Asks which hall a new showtime runs in; skipped when only one hall exists
+Task<string> askHall(Session& session) {
+    ostream& out = session.out();
+    vector<string> names;
+    {
+        BookingEngine::Turn turn;
+        const map<string, HallLayout>& halls = CinemaBookingSystem::getInstance()->getHalls();
+        if (halls.size() == 1) co_return DEFAULT_HALL;
+        out << "\nAvailable halls:" << endl;
+        for (const auto& hallPair : halls) {
+            names.push_back(hallPair.first);
+            out << names.size() << ". " << hallPair.first << " (" << hallPair.second.getRows() << " rows x "
+                << hallPair.second.getSeatsPerRow() << ", " << hallPair.second.capacity() << " seats)" << endl;
+        }
+    }
+    out << "Enter hall number: ";
+    int choice = co_await askChoice(session, 1, names.size());
+    co_return names[choice - 1];
+}
+
+// Admin flows. Like the customer flows they keep copies, never references
+// into the catalog, across suspensions: another session may change it or a
+// catalog reload may replace it meanwhile.
+Task<> addMovieFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    out << "\n=== Add New Movie ===" << endl;
+    string title = co_await ask(session, "Enter movie title: ");
+    string genre = co_await ask(session, "Enter genre: ");
+
+    double price = 0;
+    string line = co_await askWord(session, "Enter ticket price: ₱");
+    while (!(istringstream(line) >> price) || price <= 0) {
+        line = co_await askWord(session, "Invalid price. Please enter a positive number: ₱");
+    }
+
+    vector<pair<Schedule, string>> showtimes; // schedule, hall
+    bool addMoreSchedules = true;
+    while (addMoreSchedules) {
+        out << "\nAdding new schedule:" << endl;
+        Schedule schedule = co_await askSchedule(session);
+        string hallName = co_await askHall(session);
+        showtimes.emplace_back(schedule, hallName);
+        addMoreSchedules = co_await askConfirmation(session, "Add another schedule?");
+    }
+
+    BookingEngine::Turn turn;
+    Movie newMovie(title, genre, price);
+    for (const auto& showtime : showtimes) {
+        newMovie.addSchedule(showtime.first);
+        system->initializeSeatsForNewMovie(newMovie.getMovieID(), showtime.first.getFullSchedule(), showtime.second);
+    }
+    system->getMovies().push_back(newMovie);
+    system->saveData();
+    out << "Movie added successfully!" << endl;
+}
+
+Task<> editMovieFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+    if (BookingEngine(*system).searchMovies("", "", 0, 0).total == 0) {
+        out << "No movies available to edit." << endl;
+        co_return;
+    }
+
+    optional<Movie> picked = co_await askMovie(session, "Edit Movie");
+    if (!picked) {
+        out << "Edit cancelled." << endl;
+        co_return;
+    }
+    int movieID = picked->getMovieID();
+
+    out << "Current title: " << picked->getTitle() << endl;
+    string newTitle = co_await ask(session, "Enter new title (leave blank to keep current): ");
+    out << "Current genre: " << picked->getGenre() << endl;
+    string newGenre = co_await ask(session, "Enter new genre (leave blank to keep current): ");
+    out << "Current price: ₱" << fixed << setprecision(2) << picked->getPrice() << endl;
+    string priceLine = co_await askWord(session, "Enter new price (0 to keep current): ₱");
+    double newPrice = 0;
+    istringstream(priceLine) >> newPrice;
+
+    {
+        BookingEngine::Turn turn;
+        Movie* movie = system->findListedMovie(movieID);
+        if (!movie) {
+            out << "This movie was deleted meanwhile." << endl;
+            co_return;
+        }
+        if (!newTitle.empty()) movie->setTitle(newTitle);
+        if (!newGenre.empty()) movie->setGenre(newGenre);
+        if (newPrice > 0) movie->setPrice(newPrice);
+        system->saveData();
+    }
+
+    while (true) {
+        vector<Schedule> schedules;
+        {
+            BookingEngine::Turn turn;
+            if (Movie* movie = system->findListedMovie(movieID)) schedules = movie->getSchedules();
+        }
+        out << "\nCurrent schedules:" << endl;
+        for (size_t i = 0; i < schedules.size(); i++) {
+            out << i+1 << ". ";
+            schedules[i].display(out);
+            out << endl;
+        }
+
+        out << "\n1. Add schedule" << endl;
+        out << "2. Remove schedule" << endl;
+        out << "3. Done editing" << endl;
+        out << "Enter choice: ";
+        int scheduleChoice = co_await askChoice(session, 1, 3);
+        if (scheduleChoice == 3) break;
+
+        if (scheduleChoice == 1) {
+            out << "\nAdding new schedule:" << endl;
+            Schedule newSchedule = co_await askSchedule(session);
+            string hallName = co_await askHall(session);
+            EngineStatus status = BookingEngine(*system).addShowtime(movieID, newSchedule.getFullSchedule(), hallName);
+            if (status == ENGINE_OK) {
+                out << "Schedule added." << endl;
+            } else {
+                out << "Schedule not added: " << engineStatusText(status) << "." << endl;
+            }
+        } else if (!schedules.empty()) {
+            out << "Enter schedule number to remove: ";
+            int removeIndex = co_await askChoice(session, 1, schedules.size());
+            string showtime = schedules[removeIndex - 1].getFullSchedule();
+            BookingEngine::Turn turn;
+            if (system->hasBookingsForSchedule(movieID, showtime)) {
+                out << "Cannot remove schedule because there are existing bookings." << endl;
+            } else {
+                system->retireShowtime(movieID, showtime);
+            }
+        }
+    }
+
+    BookingEngine::withTurn([&] { system->saveData(); });
+    out << "Movie updated successfully!" << endl;
+}
+
+Task<> deleteMovieFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+    if (BookingEngine(*system).searchMovies("", "", 0, 0).total == 0) {
+        out << "No movies available to delete." << endl;
+        co_return;
+    }
+
+    optional<Movie> picked = co_await askMovie(session, "Delete Movie");
+    if (!picked) {
+        out << "Deletion cancelled." << endl;
+        co_return;
+    }
+
+    picked->displayDetails(out);
+    bool confirmed = co_await askConfirmation(session, "Are you sure you want to delete this movie?");
+    if (!confirmed) {
+        out << "Deletion cancelled." << endl;
+        co_return;
+    }
+    int movieID = picked->getMovieID();
+
+    // Count how many bookings will be affected
+    shared_ptr<const BookingSnapshot> view = system->snapshot();
+    int bookingsToRemove = count_if(view->bookings.begin(), view->bookings.end(),
+                                    [&](const Booking& booking) { return booking.getMovieID() == movieID; });
+    if (bookingsToRemove > 0) {
+        out << "\nWarning: This movie has " << bookingsToRemove << " active booking(s)." << endl;
+        bool proceed = co_await askConfirmation(session, "Deleting this movie will also remove all associated bookings. Continue?");
+        if (!proceed) {
+            out << "Deletion cancelled." << endl;
+            co_return;
+        }
+    }
+
+    // Hidden at once; bookings, seats and the catalog entry go in the background
+    BookingEngine::withTurn([&] { system->retireMovie(movieID); });
+    out << "Movie deleted successfully." << endl;
+    if (bookingsToRemove > 0) {
+        out << bookingsToRemove << " booking(s) cancelled; their records are cleared in the background." << endl;
+    }
+}
+
+void showAllBookings(ostream& out) {
+    TraceSpan span("viewAllBookings", "report");
+    shared_ptr<const BookingSnapshot> view = CinemaBookingSystem::getInstance()->snapshot();
+
+    out << "\n=== All Bookings ===" << endl;
+    if (view->bookings.empty()) {
+        out << "No bookings found." << endl;
+        return;
+    }
+
+    double totalRevenue = 0.0;
+    size_t count = 0;
+    for (const auto& booking : view->bookings) {
+        booking.displayDetails(view->movies, out);
+        totalRevenue += booking.getPrice();
+        count++;
+    }
+
+    out << "\nTotal bookings: " << count << endl;
+    out << "Total revenue: ₱" << fixed << setprecision(2) << totalRevenue << endl;
+}
+
+Task<> manageSeatsFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+    if (BookingEngine(*system).searchMovies("", "", 0, 0).total == 0) {
+        out << "No movies available to manage seats." << endl;
+        co_return;
+    }
+
+    optional<Movie> picked = co_await askMovie(session, "Manage Seats");
+    if (!picked) {
+        out << "Operation cancelled." << endl;
+        co_return;
+    }
+
+    int movieID = picked->getMovieID();
+    const vector<Schedule>& schedules = picked->getSchedules();
+    if (schedules.empty()) {
+        out << "No schedules available for this movie." << endl;
+        co_return;
+    }
+
+    out << "\nAvailable schedules for " << picked->getTitle() << ":" << endl;
+    {
+        BookingEngine::Turn turn;
+        for (size_t i = 0; i < schedules.size(); i++) {
+            out << i+1 << ". ";
+            schedules[i].display(out);
+            out << " (" << system->getShowtimeHall(movieID, schedules[i].getFullSchedule()) << ")" << endl;
+        }
+    }
+
+    out << "Enter schedule number to manage seats (0 to cancel): ";
+    int scheduleChoice = co_await askChoice(session, 0, schedules.size());
+    if (scheduleChoice == 0) {
+        out << "Operation cancelled." << endl;
+        co_return;
+    }
+
+    string selectedShowtime = schedules[scheduleChoice - 1].getFullSchedule();
+    BookingEngine::withTurn([&] { system->displaySeatLayout(movieID, selectedShowtime, out); });
+
+    out << "\n1. Add seat" << endl;
+    out << "2. Remove seat" << endl;
+    out << "3. Change hall" << endl;
+    out << "4. Back to menu" << endl;
+    out << "Enter choice: ";
+    int choice = co_await askChoice(session, 1, 4);
+
+    if (choice == 1) {
+        string newSeat = co_await ask(session, "Enter seat ID to add (must be inside the hall grid): ");
+        transform(newSeat.begin(), newSeat.end(), newSeat.begin(), ::toupper);
+        BookingEngine::Turn turn;
+        if (system->seatExists(movieID, selectedShowtime, newSeat)) {
+            out << "Seat already exists." << endl;
+        } else if (system->addSeat(movieID, selectedShowtime, newSeat)) {
+            system->saveData();
+            out << "Seat added successfully." << endl;
+        } else {
+            out << "Seat is outside this hall's layout." << endl;
+        }
+    } else if (choice == 2) {
+        string seatToRemove = co_await ask(session, "Enter seat ID to remove: ");
+        transform(seatToRemove.begin(), seatToRemove.end(), seatToRemove.begin(), ::toupper);
+        BookingEngine::Turn turn;
+        if (!system->seatExists(movieID, selectedShowtime, seatToRemove)) {
+            out << "Seat doesn't exist." << endl;
+        } else if (!system->removeSeat(movieID, selectedShowtime, seatToRemove)) {
+            out << "Cannot remove seat because it has active bookings." << endl;
+        } else {
+            system->saveData();
+            out << "Seat removed successfully." << endl;
+        }
+    } else if (choice == 3) {
+        string hallName = co_await askHall(session);
+        BookingEngine::Turn turn;
+        if (system->setShowtimeHall(movieID, selectedShowtime, hallName)) {
+            system->saveData();
+            out << "Showtime moved to " << hallName << "." << endl;
+        } else if (!system->getHalls().count(hallName)) {
+            out << "Cannot change hall because " << hallName << " does not exist." << endl;
+        } else if (system->remainingSeats(movieID, selectedShowtime) < 0) {
+            out << "Cannot change hall because this showtime has no seat map." << endl;
+        } else {
+            out << "Cannot change hall because there are existing bookings." << endl;
+        }
+    }
+}
+
+Task<> manageSchedulesFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+    if (BookingEngine(*system).searchMovies("", "", 0, 0).total == 0) {
+        out << "No movies available to manage schedules." << endl;
+        co_return;
+    }
+
+    optional<Movie> picked = co_await askMovie(session, "Manage Schedules");
+    if (!picked) {
+        out << "Operation cancelled." << endl;
+        co_return;
+    }
+
+    int movieID = picked->getMovieID();
+    out << "\nCurrent schedules for " << picked->getTitle() << ":" << endl;
+    const vector<Schedule>& schedules = picked->getSchedules();
+    for (size_t i = 0; i < schedules.size(); i++) {
+        out << i+1 << ". ";
+        schedules[i].display(out);
+        out << endl;
+    }
+
+    out << "\n1. Add schedule" << endl;
+    out << "2. Remove schedule" << endl;
+    out << "3. Add recurring schedule" << endl;
+    out << "4. Cancel or move all bookings of a schedule" << endl;
+    out << "5. Back to menu" << endl;
+    out << "Enter choice: ";
+    int choice = co_await askChoice(session, 1, 5);
+
+    if (choice == 1) {
+        out << "\nAdding new schedule:" << endl;
+        Schedule newSchedule = co_await askSchedule(session);
+        string hallName = co_await askHall(session);
+        EngineStatus status = BookingEngine(*system).addShowtime(movieID, newSchedule.getFullSchedule(), hallName);
+        if (status == ENGINE_OK) {
+            out << "Schedule added successfully." << endl;
+        } else {
+            out << "Schedule not added: " << engineStatusText(status) << "." << endl;
+        }
+    } else if (choice == 2) {
+        if (schedules.empty()) {
+            out << "No schedules to remove." << endl;
+            co_return;
+        }
+        out << "Enter schedule number to remove: ";
+        int removeIndex = co_await askChoice(session, 1, schedules.size());
+        string showtime = schedules[removeIndex - 1].getFullSchedule();
+        BookingEngine::Turn turn;
+        if (system->hasBookingsForSchedule(movieID, showtime)) {
+            out << "Cannot remove schedule because there are existing bookings." << endl;
+        } else {
+            system->retireShowtime(movieID, showtime);
+            out << "Schedule removed successfully." << endl;
+        }
+    } else if (choice == 3) {
+        string fromDate = co_await ask(session, "\nFirst date (YYYY-MM-DD): ");
+        string toDate = co_await ask(session, "Last date (YYYY-MM-DD): ");
+        string timeList = co_await ask(session, "Times (HH:MM, separated by commas): ");
+        vector<string> times;
+        istringstream timeStream(timeList);
+        string time;
+        while (getline(timeStream, time, ',')) {
+            time.erase(remove_if(time.begin(), time.end(), ::isspace), time.end());
+            if (!time.empty()) times.push_back(time);
+        }
+        out << "1. Every day" << endl;
+        out << "2. Weekdays only (Mon-Fri)" << endl;
+        bool weekdaysOnly = co_await askChoice(session, 1, 2) == 2;
+        string hallName = co_await askHall(session);
+
+        BookingEngine::RecurringResult result = BookingEngine(*system).addRecurringShowtimes(
+            movieID, fromDate, toDate, times, weekdaysOnly, hallName);
+        if (result.status != ENGINE_OK) {
+            out << "Schedules not added: " << engineStatusText(result.status)
+                << ". Check the dates (at most a year apart) and times." << endl;
+        } else {
+            out << "Added " << result.added << " schedule(s)";
+            if (result.skipped > 0) out << "; " << result.skipped << " already scheduled";
+            out << "." << endl;
+        }
+    } else if (choice == 4) {
+        if (schedules.empty()) {
+            out << "No schedules available for this movie." << endl;
+            co_return;
+        }
+        out << "Enter schedule number: ";
+        string showtime = schedules[co_await askChoice(session, 1, schedules.size()) - 1].getFullSchedule();
+        shared_ptr<const BookingSnapshot> view = system->snapshot();
+        int booked = count_if(view->bookings.begin(), view->bookings.end(), [&](const Booking& booking) {
+            return booking.getMovieID() == movieID && booking.getSchedule().getFullSchedule() == showtime;
+        });
+        if (booked == 0) {
+            out << "No bookings for this schedule." << endl;
+            co_return;
+        }
+
+        out << "\n" << booked << " booking(s) for " << showtime << "." << endl;
+        out << "1. Cancel all" << endl;
+        out << "2. Move all to another schedule" << endl;
+        out << "3. Back" << endl;
+        int action = co_await askChoice(session, 1, 3);
+        BookingEngine engine(*system);
+        BookingEngine::BulkResult result;
+        if (action == 1) {
+            bool confirmed = co_await askConfirmation(session, "Cancel all " + to_string(booked) + " booking(s)?");
+            if (!confirmed) co_return;
+            result = engine.cancelShowtime(movieID, showtime);
+        } else if (action == 2) {
+            out << "Move to schedule number: ";
+            string target = schedules[co_await askChoice(session, 1, schedules.size()) - 1].getFullSchedule();
+            out << "Free seats there: " << BookingEngine::withTurn([&] { return system->remainingSeats(movieID, target); }) << endl;
+            bool confirmed = co_await askConfirmation(session, "Move all " + to_string(booked) + " booking(s) to " + target + "?");
+            if (!confirmed) co_return;
+            result = engine.moveShowtime(movieID, showtime, target);
+        } else {
+            co_return;
+        }
+
+        if (result.status != ENGINE_OK) {
+            out << RED << "Bookings not changed: " << engineStatusText(result.status) << "." << RESET << endl;
+            if (result.moved.empty()) co_return;
+        }
+        out << "\nAffected customers:" << endl;
+        for (const auto& booking : result.cancelled) {
+            out << "  " << left << setw(16) << booking.getCustomerUsername() << right << "#" << booking.getBookingID()
+                << "  " << booking.getSeat() << "  cancelled, refund ₱" << fixed << setprecision(2)
+                << booking.getPrice() << " (" << booking.getPaymentMode() << ")" << endl;
+        }
+        for (const auto& change : result.moved) {
+            out << "  " << left << setw(16) << change.first.getCustomerUsername() << right << "#"
+                << change.first.getBookingID() << "  " << change.first.getSeat() << " -> "
+                << change.second.getSchedule().getFullSchedule() << " " << change.second.getSeat() << endl;
+        }
+        out << GREEN << (result.cancelled.size() + result.moved.size()) << " booking(s) updated." << RESET << endl;
+    }
+}
+
+void showSalesReport(ostream& out) {
+    TraceSpan span("generateReports", "report");
+    BookingEngine::SalesReport sales = BookingEngine(*CinemaBookingSystem::getInstance()).report();
+
+    if (sales.tickets == 0) {
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << YELLOW << "\t║      No bookings to generate      ║" << RESET << endl;
+        out << YELLOW << "\t║           reports.                ║" << RESET << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
+        return;
+    }
+
+    out << "\n\t╔═══════════════════════════════════════════════════╗" << endl;
+    out << CYAN << "\t║                   Sales Report                    ║" << RESET << endl;
+    out << "\t╠═══════════════════════╦═══════════╦═══════════════╣" << endl;
+    out << "\t║      Movie Title      ║  Tickets  ║    Revenue    ║" << endl;
+    out << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
+
+    for (const auto& movie : sales.movies) {
+        out << "\t║ " << YELLOW << left << setw(22) << movie.title.substr(0, 19) << RESET
+            << "║ " << CYAN << right << setw(9) << movie.tickets << RESET
+            << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << movie.revenue << RESET << " ║" << endl;
+    }
+
+    out << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
+    out << "\t║ " << CYAN << "TOTAL" << RESET << "                 ║ "
+        << CYAN << right << setw(9) << sales.tickets << RESET
+        << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << sales.revenue << RESET << " ║" << endl;
+    out << "\t╚═══════════════════════╩═══════════╩═══════════════╝" << endl;
+}
+
+Task<> bulkImportFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    out << "\n=== Bulk Import Catalog ===" << endl;
+    out << "Rows are title,genre,price,date,time (CSV) or one JSON object per line (JSONL)." << endl;
+    string path = co_await ask(session, "Enter catalog file path (0 to cancel): ");
+    if (path.empty() || path == "0") {
+        out << "Import cancelled." << endl;
+        co_return;
+    }
+
+    CinemaBookingSystem::ImportReport report = BookingEngine::withTurn([&] { return system->importCatalog(path); });
+
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << "\n\t╔═══════════════════════════════════╗" << endl;
+    out << CYAN << "\t║          Import Summary           ║" << RESET << endl;
+    out << "\t╠═══════════════════════════════════╣" << endl;
+    out << "\t║  Rows read: " << YELLOW << setw(22) << left << report.rowsRead << RESET << "║" << endl;
+    out << "\t║  Rows imported: " << GREEN << setw(18) << left << report.rowsImported << RESET << "║" << endl;
+    out << "\t║  Rows rejected: " << RED << setw(18) << left << report.errors.size() << RESET << "║" << endl;
+    out << "\t║  New movies: " << YELLOW << setw(21) << left << report.moviesCreated << RESET << "║" << endl;
+    out << "\t║  New showtimes: " << YELLOW << setw(18) << left << report.showtimesCreated << RESET << "║" << endl;
+    double rowsPerSecond = report.seconds > 0 ? report.rowsRead / report.seconds : 0.0;
+    out << "\t║  Rows/sec: " << CYAN << setw(23) << left << fixed << setprecision(0) << rowsPerSecond << RESET << "║" << endl;
+    out.flags(flags);
+    out.precision(precision);
+    out << "\t╚═══════════════════════════════════╝" << endl;
+
+    for (const auto& error : report.errors) {
+        out << RED << "  " << error << RESET << endl;
+    }
+}
+
+Task<> exportFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    out << "\n=== Export Bookings (Columnar) ===" << endl;
+    string path = co_await ask(session, "Enter output file path (e.g., bookings.ccol, 0 to cancel): ");
+    if (path.empty() || path == "0") {
+        out << "Export cancelled." << endl;
+        co_return;
+    }
+    bool includeSeats = co_await askConfirmation(session, "Include seat occupancy for every showtime?");
+
+    auto started = chrono::steady_clock::now();
+    long long rows = BookingEngine::withTurn([&] { return system->exportColumnar(path, includeSeats); });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    if (rows < 0) {
+        out << RED << "Unable to create " << path << RESET << endl;
+    } else {
+        out << GREEN << "Exported " << rows << " row(s) to " << path << " in "
+            << fixed << setprecision(3) << seconds << "s." << RESET << endl;
+    }
+}
+
+Task<> manageHallsFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    out << "\n=== Hall Layouts ===" << endl;
+    {
+        BookingEngine::Turn turn;
+        for (const auto& hallPair : system->getHalls()) {
+            const HallLayout& hall = hallPair.second;
+            out << "- " << hall.getName() << ": " << hall.getRows() << " rows x " << hall.getSeatsPerRow()
+                << ", " << hall.capacity() << " seats";
+            if (system->isHallInUse(hall.getName())) out << " (in use)";
+            out << endl;
+        }
+    }
+
+    out << "\n1. Define hall" << endl;
+    out << "2. Remove hall" << endl;
+    out << "3. Back to menu" << endl;
+    out << "Enter choice: ";
+    int choice = co_await askChoice(session, 1, 3);
+
+    if (choice == 1) {
+        string name = co_await ask(session, "Enter hall name: ");
+        if (name.empty() || name.find(',') != string::npos) {
+            out << "Hall name cannot be empty or contain commas." << endl;
+            co_return;
+        }
+        out << "Enter number of rows (1-" << HallLayout::MAX_ROWS << "): ";
+        int rows = co_await askChoice(session, 1, HallLayout::MAX_ROWS);
+        out << "Enter seats per row (1-" << HallLayout::MAX_SEATS_PER_ROW << "): ";
+        int seatsPerRow = co_await askChoice(session, 1, HallLayout::MAX_SEATS_PER_ROW);
+
+        HallLayout hall(name, rows, seatsPerRow);
+        string blockedLine = co_await ask(session, "Enter blocked positions separated by spaces (aisles/gaps, blank for none): ");
+        istringstream blockedStream(blockedLine);
+        string blocked;
+        while (blockedStream >> blocked) {
+            int index = hall.seatIndex(blocked);
+            if (index < 0) {
+                out << YELLOW << "Ignoring " << blocked << ": outside the grid." << RESET << endl;
+            } else {
+                hall.setBlocked(index, true);
+            }
+        }
+
+        BookingEngine::Turn turn;
+        if (system->defineHall(hall)) {
+            system->saveData();
+            out << "Hall " << name << " saved with " << hall.capacity() << " seats." << endl;
+        } else {
+            out << "Cannot redefine a hall that is in use or the standard hall." << endl;
+        }
+    } else if (choice == 2) {
+        string name = co_await ask(session, "Enter hall name to remove: ");
+        BookingEngine::Turn turn;
+        if (system->removeHall(name)) {
+            system->saveData();
+            out << "Hall removed." << endl;
+        } else {
+            out << "Cannot remove a hall that is in use, missing, or the standard hall." << endl;
+        }
+    }
+}
+
+void showReplicationStatus(ostream& out) {
+    const LogShipper* shipper = CinemaBookingSystem::getInstance()->replication();
+    if (!shipper) {
+        out << YELLOW << "\nNo standby configured. Start this instance with CINEMA_STANDBY=<socket> and run "
+            << "--standby <socket> elsewhere." << RESET << endl;
+        return;
+    }
+    LogShipper::Status status = shipper->status();
+    out << "\nStandby:     " << shipper->standbyPath() << (status.connected ? GREEN + " (connected)" : RED + " (not connected)")
+        << RESET << endl;
+    out << "Generation:  " << (status.generation.empty() ? "-" : status.generation) << endl;
+    out << "Shipped:     " << status.shippedBytes << " bytes in " << status.batches << " batch(es)" << endl;
+    out << "Applied:     " << status.ackedBytes << " bytes" << endl;
+    out << "Lag:         " << status.shippedBytes - status.ackedBytes << " bytes, " << fixed << setprecision(1)
+        << status.lagMicros / 1000.0 << " ms on the last batch" << endl;
+}
+
+Task<> rebuildSeatsFlow(Session& session) {
+    ostream& out = session.out();
+    bool confirmed = co_await askConfirmation(session, "Re-derive every showtime's booked seats from the booking records?");
+    if (!confirmed) {
+        out << "Rebuild cancelled." << endl;
+        co_return;
+    }
+    int changed = BookingEngine::withTurn([] { return CinemaBookingSystem::getInstance()->rebuildSeatsFromBookings(); });
+    out << GREEN << "Seat maps rebuilt; " << changed << " showtime(s) had to be corrected." << RESET << endl;
+}
+
+Task<> dataToolsFlow(Session& session) {
+    ostream& out = session.out();
+    out << "\n\t╔═══════════════════════════════════╗" << endl;
+    out << "\t║            Data Tools             ║" << endl;
+    out << "\t╠═══════════════════════════════════╣" << endl;
+    out << "\t║  1. Bulk Import Catalog           ║" << endl;
+    out << "\t║  2. Export Bookings (Columnar)    ║" << endl;
+    out << "\t║  3. Manage Hall Layouts           ║" << endl;
+    out << "\t║  4. Rebuild Seats From Bookings   ║" << endl;
+    out << "\t║  5. Replication Status            ║" << endl;
+    out << "\t║  6. Back                          ║" << endl;
+    out << "\t╚═══════════════════════════════════╝" << endl;
+
+    switch (co_await askChoice(session, 1, 6)) {
+        case 1:
+            co_await bulkImportFlow(session);
+            break;
+        case 2:
+            co_await exportFlow(session);
+            break;
+        case 3:
+            co_await manageHallsFlow(session);
+            break;
+        case 4:
+            co_await rebuildSeatsFlow(session);
+            break;
+        case 5:
+            showReplicationStatus(out);
+            break;
+        case 6:
+            break;
+    }
+}
+
+Task<> occupancyFlow(Session& session) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    ostream& out = session.out();
+
+    out << "\n=== Occupancy Heatmap ===" << endl;
+    string hallName = co_await askHall(session);
+
+    vector<pair<int, string>> movies; // movieID, title
+    {
+        BookingEngine::Turn turn;
+        for (const Movie* movie : system->listedMovies()) movies.emplace_back(movie->getMovieID(), movie->getTitle());
+    }
+    out << "\n0. All movies" << endl;
+    for (size_t i = 0; i < movies.size(); i++) {
+        out << i+1 << ". " << movies[i].second << endl;
+    }
+    out << "Enter movie number: ";
+    int movieChoice = co_await askChoice(session, 0, movies.size());
+    int movieID = movieChoice == 0 ? 0 : movies[movieChoice - 1].first;
+
+    string fromDate = co_await ask(session, "From date (YYYY-MM-DD, blank for no limit): ");
+    string toDate = co_await ask(session, "To date (YYYY-MM-DD, blank for no limit): ");
+    if ((!fromDate.empty() && !isValidDate(fromDate)) || (!toDate.empty() && !isValidDate(toDate))) {
+        out << "Invalid date format. Please use YYYY-MM-DD." << endl;
+        co_return;
+    }
+
+    // The report points into the hall table, so it is printed within the turn
+    BookingEngine::Turn turn;
+    CinemaBookingSystem::OccupancyReport report = system->occupancyReport(hallName, movieID, fromDate, toDate);
+    if (report.showtimes == 0) {
+        out << YELLOW << "\nNo showtimes match these filters." << RESET << endl;
+        co_return;
+    }
+
+    const HallLayout& hall = *report.hall;
+    out << "\n\t" << CYAN << "Seat fill rate across " << report.showtimes << " showtime(s) in " << hall.getName() << RESET << endl;
+    out << "\n\t       ";
+    for (int num = 1; num <= hall.getSeatsPerRow(); num++) {
+        out << YELLOW << setw(3) << num << RESET;
+    }
+    out << endl;
+    for (int row = 0; row < hall.getRows(); row++) {
+        out << "\t  " << YELLOW << static_cast<char>('A' + row) << RESET << "    ";
+        for (int num = 0; num < hall.getSeatsPerRow(); num++) {
+            int index = row * hall.getSeatsPerRow() + num;
+            if (report.openPerSeat[index] == 0) {
+                out << "   ";
+                continue;
+            }
+            double rate = static_cast<double>(report.bookedPerSeat[index]) / report.openPerSeat[index];
+            if (rate >= 0.75) out << "  " << RED << "#" << RESET;
+            else if (rate >= 0.5) out << "  " << YELLOW << "+" << RESET;
+            else if (rate >= 0.25) out << "  " << GREEN << ":" << RESET;
+            else if (rate > 0) out << "  " << CYAN << "." << RESET;
+            else out << "  o";
+        }
+        out << endl;
+    }
+    out << "\n\t  o = 0%   . < 25%   : < 50%   + < 75%   # >= 75%" << endl;
+
+    out << "\n\t╔═══════════╦═══════════╦═══════════╦═══════════╗" << endl;
+    out << CYAN << "\t║   Slot    ║ Showtimes ║  Booked   ║   Fill    ║" << RESET << endl;
+    out << "\t╠═══════════╬═══════════╬═══════════╬═══════════╣" << endl;
+    for (const auto& slotPair : report.slots) {
+        const auto& slot = slotPair.second;
+        double fill = slot.seats > 0 ? 100.0 * slot.booked / slot.seats : 0.0;
+        out << "\t║ " << YELLOW << left << setw(10) << slotPair.first << RESET
+            << "║ " << right << setw(9) << slot.showtimes
+            << " ║ " << right << setw(9) << slot.booked
+            << " ║ " << GREEN << right << setw(8) << fixed << setprecision(1) << fill << "%" << RESET << " ║" << endl;
+    }
+    out << "\t╚═══════════╩═══════════╩═══════════╩═══════════╝" << endl;
+    out << "\tComputed in " << fixed << setprecision(3) << report.seconds * 1000 << " ms." << endl;
+}
+
+void showArchivedReport(ostream& out) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    shared_ptr<const BookingSnapshot> view = system->snapshot();
+    map<int, pair<int, double>> stats = BookingEngine::withTurn([&] { return system->archivedSales(); });
+
+    if (stats.empty()) {
+        out << YELLOW << "\nNo archived bookings yet." << RESET << endl;
+        return;
+    }
+
+    int totalTickets = 0;
+    double totalRevenue = 0.0;
+    out << "\n\t╔═══════════════════════════════════════════════════╗" << endl;
+    out << CYAN << "\t║              Archived Sales Report                ║" << RESET << endl;
+    out << "\t╠═══════════════════════╦═══════════╦═══════════════╣" << endl;
+    out << "\t║      Movie Title      ║  Tickets  ║    Revenue    ║" << endl;
+    out << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
+    for (const auto& entry : stats) {
+        string title = "Movie #" + to_string(entry.first);
+        for (const auto& movie : view->movies) {
+            if (movie.getMovieID() == entry.first) {
+                title = movie.getTitle();
+                break;
+            }
+        }
+        out << "\t║ " << YELLOW << left << setw(22) << title.substr(0, 19) << RESET
+            << "║ " << CYAN << right << setw(9) << entry.second.first << RESET
+            << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << entry.second.second << RESET << " ║" << endl;
+        totalTickets += entry.second.first;
+        totalRevenue += entry.second.second;
+    }
+    out << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
+    out << "\t║ " << CYAN << "TOTAL" << RESET << "                 ║ "
+        << CYAN << right << setw(9) << totalTickets << RESET
+        << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << totalRevenue << RESET << " ║" << endl;
+    out << "\t╚═══════════════════════╩═══════════╩═══════════════╝" << endl;
+}
+
+void archiveNow(ostream& out) {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    int total = 0, moved = 0;
+    do {
+        moved = BookingEngine::withTurn([&] { return system->archivePastShowtimes(ARCHIVE_BATCH_SIZE); });
+        total += moved;
+    } while (moved > 0);
+    out << GREEN << "\nArchived " << total << " past showtime(s)." << RESET << endl;
+}
+
+// Lobby display: best-filled showtimes this week and best-selling movies today
+void showPopularityBoard(ostream& out) {
+    const size_t topCount = 10;
+    BookingEngine::Turn turn;
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    string today = currentDate();
+    auto titleOf = [&](int movieID) {
+        Movie* movie = system->findListedMovie(movieID);
+        return movie ? movie->getTitle().substr(0, 24) : "#" + to_string(movieID);
+    };
+
+    string week = weekStartOf(today);
+    out << "\n\t" << CYAN << "Top showtimes by fill rate, week of " << week << RESET << endl;
+    vector<pair<pair<int, string>, double>> showtimes = system->topShowtimesByFill(week, topCount);
+    if (showtimes.empty()) out << "\t" << YELLOW << "No tickets sold for this week yet." << RESET << endl;
+    for (size_t i = 0; i < showtimes.size(); i++) {
+        out << "\t" << setw(2) << right << i + 1 << ". " << YELLOW << left << setw(25) << titleOf(showtimes[i].first.first)
+            << RESET << showtimes[i].first.second << "  " << GREEN << right << setw(5) << fixed << setprecision(1)
+            << showtimes[i].second * 100 << "%" << RESET << endl;
+    }
+
+    out << "\n\t" << CYAN << "Top movies by revenue, showing " << today << RESET << endl;
+    vector<pair<int, double>> movies = system->topMoviesByRevenue(today, topCount);
+    if (movies.empty()) out << "\t" << YELLOW << "No tickets sold for today yet." << RESET << endl;
+    for (size_t i = 0; i < movies.size(); i++) {
+        out << "\t" << setw(2) << right << i + 1 << ". " << YELLOW << left << setw(25) << titleOf(movies[i].first)
+            << RESET << "₱" << GREEN << right << setw(10) << fixed << setprecision(2) << movies[i].second << RESET << endl;
+    }
+}
+
+Task<> analyticsFlow(Session& session) {
+    ostream& out = session.out();
+    out << "\n\t╔═══════════════════════════════════╗" << endl;
+    out << "\t║             Analytics             ║" << endl;
+    out << "\t╠═══════════════════════════════════╣" << endl;
+    out << "\t║  1. Occupancy Heatmap             ║" << endl;
+    out << "\t║  2. Archived Sales Report         ║" << endl;
+    out << "\t║  3. Archive Past Showtimes Now    ║" << endl;
+    out << "\t║  4. Popularity Board              ║" << endl;
+    out << "\t║  5. Back                          ║" << endl;
+    out << "\t╚═══════════════════════════════════╝" << endl;
+
+    switch (co_await askChoice(session, 1, 5)) {
+        case 1:
+            co_await occupancyFlow(session);
+            break;
+        case 2:
+            showArchivedReport(out);
+            break;
+        case 3:
+            archiveNow(out);
+            break;
+        case 4:
+            showPopularityBoard(out);
+            break;
+        case 5:
+            break;
+    }
+}
+
+Task<> adminFlow(Session& session) {
+    ostream& out = session.out();
+    while (true) {
+        out << "\n\n\t╔═══════════════════════════════════╗" << endl;
+        out << "\t║           Admin Menu              ║" << endl;
+        out << "\t╠═══════════════════════════════════╣" << endl;
+        out << "\t║  1. Add Movie                     ║" << endl;
+        out << "\t║  2. Edit Movie                    ║" << endl;
+        out << "\t║  3. Delete Movie                  ║" << endl;
+        out << "\t║  4. View All Bookings             ║" << endl;
+        out << "\t║  5. Manage Seats                  ║" << endl;
+        out << "\t║  6. Manage Schedules              ║" << endl;
+        out << "\t║  7. Generate Reports              ║" << endl;
+        out << "\t║  8. Data Tools                    ║" << endl;
+        out << "\t║  9. Analytics                     ║" << endl;
+        out << "\t║ 10. Logout                        ║" << endl;
+        out << "\t╚═══════════════════════════════════╝" << endl;
+
+        switch (co_await askChoice(session, 1, 10)) {
+            case 1:
+                co_await addMovieFlow(session);
+                break;
+            case 2:
+                co_await editMovieFlow(session);
+                break;
+            case 3:
+                co_await deleteMovieFlow(session);
+                break;
             case 4:
-                cout << "\n";
-                cancelBooking();
+                showAllBookings(out);
                 break;
             case 5:
-                cout << "\n\t╔═══════════════════════════════════╗" << endl;
-                cout << YELLOW << "\t║          Logging out...           ║" << RESET << endl;
-                cout << "\t╚═══════════════════════════════════╝" << endl;
-                cout << "\n";
-                logout = true;
+                co_await manageSeatsFlow(session);
                 break;
+            case 6:
+                co_await manageSchedulesFlow(session);
+                break;
+            case 7:
+                showSalesReport(out);
+                break;
+            case 8:
+                co_await dataToolsFlow(session);
+                break;
+            case 9:
+                co_await analyticsFlow(session);
+                break;
+            case 10:
+                out << "\n\t╔═══════════════════════════════════╗" << endl;
+                out << YELLOW << "\t║          Logging out...           ║" << RESET << endl;
+                out << "\t╚═══════════════════════════════════╝" << endl;
+                out << "\n";
+                co_return;
+        }
+    }
+}
+
+Task<> loginFlow(Session& session) {
+    ostream& out = session.out();
+    while (true) {
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << "\t║             Login                 ║" << endl;
+        out << "\t╚═══════════════════════════════════╝\n" << endl;
+
+        string username = co_await ask(session, "  Username (or '0' to cancel): ");
+        if (username.find(' ') != string::npos) {
+            out << RED << "\n  Error: Username cannot contain spaces. Please try again." << RESET << endl;
+            continue;
+        }
+        if (username == "0") co_return;
+
+        string password = co_await ask(session, "  Password: ");
+        while (password.find(' ') != string::npos) {
+            out << RED << "\n  Error: Password cannot contain spaces. Please try again." << RESET << endl;
+            password = co_await ask(session, "  Password: ");
+        }
+        string userType = BookingEngine::withTurn([&] {
+            User* user = CinemaBookingSystem::getInstance()->authenticate(username, password);
+            return user ? user->getUserType() : "";
+        });
+        if (userType.empty()) {
+            out << RED << "\n  Invalid username or password. Please try again." << RESET << endl;
+            continue;
+        }
+        out << GREEN << "\n  Login successful!" << RESET << endl;
+        if (userType == "CUSTOMER") co_await customerFlow(session, username);
+        else co_await adminFlow(session);
+        co_return;
+    }
+}
+
+Task<> registerFlow(Session& session) {
+    ostream& out = session.out();
+    while (true) {
+        out << "\n\t╔═══════════════════════════════════╗" << endl;
+        out << "\t║        User Registration          ║" << endl;
+        out << "\t╚═══════════════════════════════════╝\n" << endl;
+
+        string username;
+        while (true) {
+            username = co_await ask(session, "  Username (no spaces allowed): ");
+            if (username.find(' ') != string::npos) {
+                out << RED << "\n  Error: Username cannot contain spaces. Please try again." << RESET << endl;
+            } else if (username.empty()) {
+                out << RED << "\n  Error: Username cannot be empty. Please try again." << RESET << endl;
+            } else {
+                break;
+            }
+        }
+        bool taken = BookingEngine::withTurn([&] {
+            const vector<unique_ptr<User>>& users = CinemaBookingSystem::getInstance()->getUsers();
+            return any_of(users.begin(), users.end(), [&](const unique_ptr<User>& user) { return user->getUsername() == username; });
+        });
+        if (taken) {
+            out << RED << "\n  Error: Username already exists. Please choose another." << RESET << endl;
+            continue;
+        }
+        string password;
+        while (true) {
+            password = co_await ask(session, "  Password (no spaces allowed): ");
+            if (password.find(' ') != string::npos) {
+                out << RED << "\n  Error: Password cannot contain spaces. Please try again." << RESET << endl;
+            } else if (password.empty()) {
+                out << RED << "\n  Error: Password cannot be empty. Please try again." << RESET << endl;
+            } else {
+                break;
+            }
+        }
+        string name = co_await ask(session, "  Full Name: ");
+
+        bool confirmed = co_await askConfirmation(session, "Confirm registration?");
+        if (!confirmed) {
+            out << YELLOW << "\n  Registration cancelled." << RESET << endl;
+            co_return;
+        }
+        if (!BookingEngine::withTurn([&] { return CinemaBookingSystem::getInstance()->registerCustomer(username, password, name); })) {
+            out << RED << "\n  Error: Username was just taken. Please choose another." << RESET << endl;
+            continue;
+        }
+        out << GREEN << "\n  Registration successful! You can now login." << RESET << endl;
+        co_return;
+    }
+}
+
+// Main menu of one session; returns when the user exits or input runs out
+Task<> runSession(Session& session) {
+    ostream& out = session.out();
+    try {
+        bool exitSession = false;
+        while (!exitSession) {
+            out << "\n\t╔═══════════════════════════════════╗" << endl;
+            out << "\t║      Cinema Booking System        ║" << endl;
+            out << "\t╠═══════════════════════════════════╣" << endl;
+            out << "\t║  1. Login                         ║" << endl;
+            out << "\t║  2. Register                      ║" << endl;
+            out << "\t║  3. Exit                          ║" << endl;
+            out << "\t╚═══════════════════════════════════╝" << endl;
+
+            switch (co_await askChoice(session, 1, 3)) {
+                case 1:
+                    co_await loginFlow(session);
+                    break;
+                case 2:
+                    co_await registerFlow(session);
+                    break;
+                case 3:
+                    exitSession = co_await askConfirmation(session, "Are you sure you want to exit?");
+                    break;
+            }
+        }
+    } catch (const SessionEnded&) {
+        out << YELLOW << "\n  [input closed]" << RESET << endl;
+    }
+}
+
+// Drives sessions from a script: each pass hands every waiting session its
+// next line, then resumes it until it waits again. Sessions are split across
+// worker threads by index; the engine itself is single-threaded, so
+// sessions resume in parallel and only serialize on BookingEngine::Turn
+// where they read or commit. A shard with nothing to run sleeps on
+// inputArrived until feed() or close() gives it work.
+class SessionLoop {
+private:
+    vector<unique_ptr<Session>> sessions;
+    vector<size_t> cursors; // next script line per session
+    vector<string> script;
+    mutex queueMutex; // only pairs with inputArrived
+    condition_variable inputArrived;
+    atomic<uint64_t> linesFed{0};
+
+    // "{n}" in a script line becomes the session number, so scripted users
+    // can register distinct accounts
+    static string expand(string line, size_t number) {
+        for (size_t at = line.find("{n}"); at != string::npos; at = line.find("{n}", at)) {
+            line.replace(at, 3, to_string(number));
+        }
+        return line;
+    }
+
+    // Hands an idle session its next script line, or closes it at the end
+    // of the script. Called by the shard that owns the session.
+    void feedFromScript(size_t i) {
+        Session& session = *sessions[i];
+        if (!session.idle() || cursors[i] == SIZE_MAX) return;
+        if (cursors[i] < script.size()) {
+            session.feed(expand(script[cursors[i]++], i + 1));
+            linesFed++;
+        } else {
+            session.close();
+        }
+    }
+
+    // Some session of the shard can be fed from the script or resumed
+    bool shardReady(size_t first, size_t stride) const {
+        for (size_t i = first; i < sessions.size(); i += stride) {
+            if (sessions[i]->ready() || (sessions[i]->idle() && cursors[i] != SIZE_MAX)) return true;
+        }
+        return false;
+    }
+
+    void runShard(size_t first, size_t stride, bool maintenance) {
+        while (true) {
+            if (maintenance) {
+                BookingEngine::Turn turn;
+                CinemaBookingSystem::getInstance()->runMaintenance();
+            }
+            bool active = false;
+            bool progressed = false;
+            for (size_t i = first; i < sessions.size(); i += stride) {
+                Session& session = *sessions[i];
+                if (session.finished()) continue;
+                active = true;
+                feedFromScript(i);
+                if (!session.ready()) continue;
+                session.resume();
+                progressed = true;
+                if (i > 0) session.takeOutput(); // only the first transcript is kept
+            }
+            if (!active) return;
+            if (progressed) continue;
+
+            unique_lock<mutex> lock(queueMutex);
+            auto ready = [&] { return shardReady(first, stride); };
+            // The maintenance shard still wakes up once a second for housekeeping
+            if (maintenance) inputArrived.wait_for(lock, chrono::seconds(1), ready);
+            else inputArrived.wait(lock, ready);
+        }
+    }
+
+public:
+    explicit SessionLoop(vector<string> lines) : script(std::move(lines)) {}
+
+    void addSessions(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            sessions.push_back(make_unique<Session>());
+            sessions.back()->attach(runSession(*sessions.back()));
+        }
+        cursors.resize(sessions.size(), 0);
+    }
+
+    // A session fed from outside the script (a terminal, a socket) through
+    // feed() and close(); returns its number. Add these before run().
+    size_t addFedSession() {
+        addSessions(1);
+        cursors.back() = SIZE_MAX;
+        return sessions.size() - 1;
+    }
+
+    void feed(size_t session, const string& line) {
+        sessions[session]->feed(line);
+        lock_guard<mutex> lock(queueMutex);
+        inputArrived.notify_all();
+    }
+
+    void close(size_t session) {
+        sessions[session]->close();
+        lock_guard<mutex> lock(queueMutex);
+        inputArrived.notify_all();
+    }
+
+    void run(size_t threadCount) {
+        threadCount = max<size_t>(1, min(threadCount, sessions.size()));
+        vector<thread> workers;
+        for (size_t w = 1; w < threadCount; w++) {
+            workers.emplace_back(&SessionLoop::runShard, this, w, threadCount, false);
+        }
+        runShard(0, threadCount, true);
+        for (auto& worker : workers) worker.join();
+    }
+
+    uint64_t linesConsumed() const { return linesFed; }
+    string firstTranscript() { return sessions.empty() ? "" : sessions[0]->takeOutput(); }
+
+    size_t failedSessions() const {
+        size_t failed = 0;
+        for (const auto& session : sessions) {
+            if (exception_ptr error = session->error()) {
+                failed++;
+                try {
+                    rethrow_exception(error);
+                } catch (const exception& e) {
+                    cerr << "Session failed: " << e.what() << endl;
+                } catch (...) {
+                    cerr << "Session failed." << endl;
+                }
+            }
+        }
+        return failed;
+    }
+};
+
+// --replay: runs the script (one input line per line, '#' lines skipped) in
+// sessionCount concurrent sessions without a terminal. Session 1's transcript
+// goes to stdout, the summary to stderr.
+int runReplay(const string& path, int sessionCount, int threadCount) {
+    ifstream scriptFile(path);
+    if (!scriptFile) {
+        cerr << "Unable to open replay script " << path << endl;
+        return 1;
+    }
+    vector<string> lines;
+    string line;
+    while (getline(scriptFile, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] != '#') lines.push_back(line);
+    }
+
+    CinemaBookingSystem::getInstance();
+    SessionLoop loop(lines);
+    loop.addSessions(max(1, sessionCount));
+    auto started = chrono::steady_clock::now();
+    loop.run(max(1, threadCount));
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    cout << loop.firstTranscript() << flush;
+    size_t failed = loop.failedSessions();
+    cerr << "Replayed " << max(1, sessionCount) << " sessions (" << loop.linesConsumed() << " input lines) on "
+         << max(1, threadCount) << " threads in " << fixed << setprecision(3) << seconds << " s";
+    if (seconds > 0) cerr << " (" << setprecision(0) << loop.linesConsumed() / seconds << " lines/s)";
+    cerr << endl;
+    CinemaBookingSystem::cleanup();
+    return failed == 0 ? 0 : 1;
+}
+
+// The interactive console: one session on cout, fed from cin a line at a
+// time. Housekeeping runs before each line is read, as it did between menu
+// actions.
+void runConsole() {
+    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    Session session(cout);
+    session.attach(runSession(session));
+    session.resume();
+    string line;
+    while (!session.finished()) {
+        BookingEngine::withTurn([&] { system->runMaintenance(); });
+        if (getline(cin, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            session.feed(line);
+        } else {
+            session.close();
         }
+        session.resume();
     }
+    if (exception_ptr error = session.error()) rethrow_exception(error);
 }
+#endif
 
-// Admin method implementations
-void Admin::addMovie() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    
-    string title, genre;
-    
-    cout << "\n=== Add New Movie ===" << endl;
-    cout << "Enter movie title: ";
-    getline(cin, title);
-    cout << "Enter genre: ";
-    getline(cin, genre);
-    
-    double price;
-    cout << "Enter ticket price: ₱";
-    while (!(cin >> price) || price <= 0) {
-        cout << "Invalid price. Please enter a positive number: ₱";
-        cin.clear();
-        clearInputBuffer();
+#ifdef __linux__
+static volatile sig_atomic_t serverStopRequested = 0;
+
+// Owns the engine and serves the wire protocol on a Unix domain socket. One
+// thread multiplexes every connection with epoll. The frames of every
+// connection ready in one wakeup are handled as one GroupCommit, so their
+// commits share a single journal write and fsync; the responses are sent
+// only after it.
+class BookingServer {
+private:
+    struct Connection {
+        string in;
+        string out;
+    };
+
+    string path;
+    int listenFd = -1;
+    int epollFd = -1;
+    map<int, Connection> connections;
+    uint64_t requestsServed = 0;
+
+    static uint64_t cpuMicros() {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
     }
-    clearInputBuffer();
-    
-    Movie newMovie(title, genre, price);
-    
-    bool addMoreSchedules = true;
-    while (addMoreSchedules) {
-        cout << "\nAdding new schedule:" << endl;
-        Schedule schedule = system->getValidSchedule();
-        newMovie.addSchedule(schedule);
-        
-        system->initializeSeatsForNewMovie(newMovie.getMovieID(), schedule.getDate());
-        
-        addMoreSchedules = getConfirmation("Add another schedule?");
+
+    uint8_t handle(uint8_t op, WireReader& request, WireWriter& response) {
+        CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+        switch (op) {
+            case OP_PING:
+                return WIRE_OK;
+            case OP_SEATS_LEFT: {
+                int movieID = request.getU32();
+                string showtime = request.getString();
+                response.putU32(static_cast<uint32_t>(system->remainingSeats(movieID, showtime)));
+                return WIRE_OK;
+            }
+            case OP_BOOK:
+                return system->addBooking(request.getBooking()) ? WIRE_OK : WIRE_CONFLICT;
+            case OP_CANCEL:
+                return system->cancelTicket(request.getBooking()) ? WIRE_OK : WIRE_CONFLICT;
+            case OP_CHANGE: {
+                Booking ticket = request.getBooking();
+                Booking replacement = request.getBooking();
+                return system->changeTicket(ticket, replacement) ? WIRE_OK : WIRE_CONFLICT;
+            }
+            case OP_STATS:
+                response.putU64(requestsServed);
+                response.putU64(cpuMicros());
+                return WIRE_OK;
+            default:
+                return WIRE_UNKNOWN_OP;
+        }
     }
-    
-    movies.push_back(newMovie);
-    system->saveData();
-    cout << "Movie added successfully!" << endl;
-}
 
-void Admin::editMovie() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    
-    if (movies.empty()) {
-        cout << "No movies available to edit." << endl;
-        return;
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
     }
-    
-    cout << "\n=== Available Movies ===" << endl;
-    for (size_t i = 0; i < movies.size(); i++) {
-        cout << i+1 << ".";
-        movies[i].displayDetails();
+
+    void watch(int fd, bool wantWrite, int operation) {
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = fd;
+        epoll_ctl(epollFd, operation, fd, &event);
     }
-    
-    cout << "Enter movie ID to edit (0 to cancel): ";
-    int movieChoice = getValidChoice(0, movies.size());
-    
-    if (movieChoice == 0) {
-        cout << "Edit cancelled." << endl;
-        return;
+
+    void acceptConnections() {
+        int fd;
+        while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            connections[fd];
+            watch(fd, false, EPOLL_CTL_ADD);
+        }
     }
-    
-    Movie& movieToEdit = movies[movieChoice - 1];
-    
-    string newTitle, newGenre;
-    double newPrice;
-    cout << "Current title: " << movieToEdit.getTitle() << endl;
-    cout << "Enter new title (leave blank to keep current): ";
-    getline(cin, newTitle);
-    
-    cout << "Current genre: " << movieToEdit.getGenre() << endl;
-    cout << "Enter new genre (leave blank to keep current): ";
-    getline(cin, newGenre);
-    
-    cout << "Current price: ₱" << fixed << setprecision(2) << movieToEdit.getPrice() << endl;
-    cout << "Enter new price (0 to keep current): ₱";
-    cin >> newPrice;
-    clearInputBuffer();
-    
-    if (!newTitle.empty() || !newGenre.empty() || newPrice > 0) {
-        movieToEdit = Movie(
-            newTitle.empty() ? movieToEdit.getTitle() : newTitle,
-            newGenre.empty() ? movieToEdit.getGenre() : newGenre,
-            newPrice <= 0 ? movieToEdit.getPrice() : newPrice
-        );
+
+    // Returns false if the connection should be closed
+    bool readRequests(int fd, Connection& connection) {
+        char buffer[16384];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) connection.in.append(buffer, n);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+
+        TraceSpan span("serveBatch", "server");
+        string frame;
+        try {
+            while (takeFrame(connection.in, frame)) {
+                WireReader request(frame, 0);
+                uint32_t requestID = request.getU32();
+                uint8_t op = request.getU8();
+                WireWriter response;
+                uint8_t status;
+                try {
+                    status = handle(op, request, response);
+                } catch (const out_of_range&) {
+                    status = WIRE_BAD_REQUEST;
+                    response = WireWriter();
+                }
+                connection.out += response.frame(requestID, status);
+                requestsServed++;
+            }
+        } catch (const length_error&) {
+            return false;
+        }
+        return true;
     }
-    
-    bool editingSchedules = true;
-    while (editingSchedules) {
-        cout << "\nCurrent schedules:" << endl;
-        const vector<Schedule>& schedules = movieToEdit.getSchedules();
-        for (size_t i = 0; i < schedules.size(); i++) {
-            cout << i+1 << ". ";
-            schedules[i].display();
-            cout << endl;
+
+    bool writeResponses(int fd, Connection& connection) {
+        while (!connection.out.empty()) {
+            ssize_t n = send(fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+            connection.out.erase(0, n);
         }
-        
-        cout << "\n1. Add schedule" << endl;
-        cout << "2. Remove schedule" << endl;
-        cout << "3. Done editing" << endl;
-        cout << "Enter choice: ";
-        int scheduleChoice = getValidChoice(1, 3);
-        
-        switch (scheduleChoice) {
-            case 1: {
-                cout << "\nAdding new schedule:" << endl;
-                Schedule newSchedule = system->getValidSchedule();
-                movieToEdit.addSchedule(newSchedule);
-                system->initializeSeatsForNewMovie(movieToEdit.getMovieID(), newSchedule.getDate());
-                cout << "Schedule added." << endl;
-                break;
+        return true;
+    }
+
+public:
+    explicit BookingServer(const string& socketPath) : path(socketPath) {}
+
+    ~BookingServer() {
+        for (auto& connection : connections) close(connection.first);
+        if (epollFd >= 0) close(epollFd);
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(path.c_str());
+        }
+    }
+
+    bool start() {
+        listenFd = listenUnixSocket(path);
+        if (listenFd < 0) return false;
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) return false;
+        watch(listenFd, false, EPOLL_CTL_ADD);
+        return true;
+    }
+
+    // Serves until SIGINT/SIGTERM. Idle seconds run the same maintenance the
+    // menus do, which also picks up catalog changes made by admin instances.
+    void run() {
+        vector<epoll_event> events(64);
+        while (!serverStopRequested) {
+            int ready = epoll_wait(epollFd, events.data(), events.size(), 1000);
+            if (ready < 0 && errno != EINTR) break;
+            if (ready <= 0) {
+                CinemaBookingSystem::getInstance()->runMaintenance();
+                continue;
             }
-            case 2:
-                if (!schedules.empty()) {
-                    cout << "Enter schedule number to remove: ";
-                    int removeIndex = getValidChoice(1, schedules.size());
-                    
-                    if (system->hasBookingsForSchedule(movieToEdit.getMovieID(), schedules[removeIndex - 1].getDate())) {
-                        cout << "Cannot remove schedule because there are existing bookings." << endl;
-                    } else {
-                        system->removeSeatsForMovie(movieToEdit.getMovieID(), schedules[removeIndex - 1].getDate());
-                        movieToEdit.removeSchedule(removeIndex - 1);
+            vector<bool> open(ready, false);
+            {
+                CinemaBookingSystem::GroupCommit group(*CinemaBookingSystem::getInstance());
+                for (int i = 0; i < ready; i++) {
+                    int fd = events[i].data.fd;
+                    if (fd == listenFd) {
+                        acceptConnections();
+                        continue;
                     }
+                    auto found = connections.find(fd);
+                    if (found == connections.end()) continue;
+                    open[i] = !(events[i].events & (EPOLLERR | EPOLLHUP));
+                    if (open[i] && (events[i].events & EPOLLIN)) open[i] = readRequests(fd, found->second);
                 }
-                break;
-            case 3:
-                editingSchedules = false;
-                break;
+            }
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                auto found = connections.find(fd);
+                if (fd == listenFd || found == connections.end()) continue;
+                Connection& connection = found->second;
+                if (open[i]) open[i] = writeResponses(fd, connection);
+                if (!open[i] || (events[i].events & EPOLLRDHUP && connection.out.empty())) {
+                    closeConnection(fd);
+                } else {
+                    watch(fd, !connection.out.empty(), EPOLL_CTL_MOD);
+                }
+            }
         }
     }
-    
-    system->saveData();
-    cout << "Movie updated successfully!" << endl;
-}
+};
 
-void Admin::deleteMovie() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    vector<Booking>& bookings = system->getBookings();
-    
-    if (movies.empty()) {
-        cout << "No movies available to delete." << endl;
-        return;
-    }
-    
-    cout << "\n=== Available Movies ===" << endl;
-    for (size_t i = 0; i < movies.size(); i++) {
-        cout << i+1 << ".";
-        movies[i].displayDetails();
+// Measures the server with pipelined requests from several connections, one
+// thread each. "Per core" divides by the CPU time the server itself used.
+int runLoadGenerator(const string& path, int connectionCount, int requestsPerConnection, int depth) {
+    int movieID = 0;
+    string showtime;
+    ifstream movieFile("movies.txt");
+    string line;
+    if (getline(movieFile, line)) {
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(line);
+        while (getline(tokenStream, token, ',')) tokens.push_back(token);
+        if (tokens.size() >= 6) {
+            movieID = atoi(tokens[0].c_str());
+            showtime = tokens[4] + " " + tokens[5];
+        }
     }
-    
-    cout << "Enter movie ID to delete (0 to cancel): ";
-    int movieChoice = getValidChoice(0, movies.size());
-    
-    if (movieChoice == 0) {
-        cout << "Deletion cancelled." << endl;
-        return;
+
+    auto serverStats = [&](uint64_t& served, uint64_t& cpu) {
+        BookingClient client;
+        string response;
+        if (!client.connectTo(path) || client.call(OP_STATS, WireWriter(), response) != WIRE_OK) return false;
+        WireReader reader(response, 0);
+        served = reader.getU64();
+        cpu = reader.getU64();
+        return true;
+    };
+
+    uint64_t servedBefore, cpuBefore, servedAfter, cpuAfter;
+    if (!serverStats(servedBefore, cpuBefore)) {
+        cerr << "No booking server listening on " << path << endl;
+        return 1;
     }
-    
-    if (getConfirmation("Are you sure you want to delete this movie?")) {
-        int movieID = movies[movieChoice - 1].getMovieID();
-        
-        // Count how many bookings will be affected
-        int bookingsToRemove = 0;
-        for (const auto& booking : bookings) {
-            if (booking.getMovieID() == movieID) {
-                bookingsToRemove++;
-            }
-        }
-        
-        if (bookingsToRemove > 0) {
-            cout << "\nWarning: This movie has " << bookingsToRemove << " active booking(s)." << endl;
-            if (!getConfirmation("Deleting this movie will also remove all associated bookings. Continue?")) {
-                cout << "Deletion cancelled." << endl;
+
+    WireWriter request;
+    request.putU32(movieID);
+    request.putString(showtime);
+    atomic<long long> completed(0);
+    auto started = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int c = 0; c < connectionCount; c++) {
+        workers.emplace_back([&]() {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if (fd >= 0) close(fd);
                 return;
             }
-            
-            // Remove all bookings for this movie
-            auto it = remove_if(bookings.begin(), bookings.end(),
-                [movieID](const Booking& booking) {
-                    return booking.getMovieID() == movieID;
-                });
-            bookings.erase(it, bookings.end());
-            cout << bookingsToRemove << " booking(s) have been removed." << endl;
-        }
-        
-        // Remove all seats for this movie
-        for (const auto& schedule : movies[movieChoice - 1].getSchedules()) {
-            system->removeSeatsForMovie(movieID, schedule.getDate());
-        }
-        
-        // Remove the movie
-        movies.erase(movies.begin() + movieChoice - 1);
-        system->saveData();
-        cout << "Movie deleted successfully." << endl;
-    } else {
-        cout << "Deletion cancelled." << endl;
+            int sent = 0, received = 0;
+            string pending, frame;
+            while (received < requestsPerConnection) {
+                string out;
+                while (sent < requestsPerConnection && sent - received < depth) {
+                    out += request.frame(sent++, OP_SEATS_LEFT);
+                }
+                if (!out.empty() && send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size())) break;
+                char buffer[65536];
+                ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) break;
+                pending.append(buffer, n);
+                while (takeFrame(pending, frame)) received++;
+            }
+            completed += received;
+            close(fd);
+        });
     }
-}
+    for (auto& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    serverStats(servedAfter, cpuAfter);
 
-void Admin::viewAllBookings() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    const vector<Booking>& bookings = system->getBookings();
-    const vector<Movie>& movies = system->getMovies();
-    
-    cout << "\n=== All Bookings ===" << endl;
-    
-    if (bookings.empty()) {
-        cout << "No bookings found." << endl;
-        return;
+    double serverCpu = (cpuAfter - cpuBefore) / 1e6;
+    cout << fixed << setprecision(0);
+    cout << "Requests:        " << completed.load() << " over " << connectionCount << " connection(s), depth " << depth << endl;
+    cout << "Elapsed:         " << setprecision(3) << seconds << " s" << endl;
+    cout << "Throughput:      " << setprecision(0) << completed.load() / seconds << " req/s" << endl;
+    cout << "Server CPU:      " << setprecision(3) << serverCpu << " s" << endl;
+    if (serverCpu > 0) {
+        cout << "Per server core: " << setprecision(0) << (servedAfter - servedBefore) / serverCpu << " req/s" << endl;
     }
-    
-    double totalRevenue = 0.0;
-    for (const auto& booking : bookings) {
-        booking.displayDetails(movies);
-        totalRevenue += booking.getPrice();
+    return 0;
+}
+
+// Runs the booking server until SIGINT/SIGTERM (--server, and a promoted standby)
+int serveBookings(const string& socketPath) {
+    CinemaBookingSystem::getInstance();
+    BookingServer server(socketPath);
+    if (!server.start()) {
+        cerr << "Unable to listen on " << socketPath << endl;
+        CinemaBookingSystem::cleanup();
+        return 1;
     }
-    
-    cout << "\nTotal bookings: " << bookings.size() << endl;
-    cout << "Total revenue: ₱" << fixed << setprecision(2) << totalRevenue << endl;
+    signal(SIGINT, [](int) { serverStopRequested = 1; });
+    signal(SIGTERM, [](int) { serverStopRequested = 1; });
+    cout << "Booking server listening on " << socketPath << " (Ctrl+C to stop)" << endl;
+    server.run();
+    CinemaBookingSystem::cleanup();
+    return 0;
 }
 
-void Admin::manageSeats() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    
-    if (movies.empty()) {
-        cout << "No movies available to manage seats." << endl;
-        return;
+// The standby's copy of the primary, one journal generation at a time: the
+// catalog files sent with it, the users registered since, and the live
+// bookings in commit order. The last complete generation is kept while the
+// next one streams in, so the primary dying during a RESET loses nothing.
+class StandbyReplica {
+private:
+    struct Generation {
+        string id;
+        map<string, string> incoming;            // files still arriving
+        map<string, string> files;               // complete files
+        map<uint64_t, string> bookings;          // commit order -> booking line
+        unordered_map<string, uint64_t> tickets; // showtime + seat + customer -> commit order
+        vector<string> userLines;
+        vector<string> tombstoneLines; // deletions since the RETIRED_FILE copy
+        uint64_t nextSeq = 0;
+        bool checkpointed = false;
+
+        bool complete() const { return checkpointed && files.size() == size(REPLICATED_FILES); }
+    };
+
+    Generation live;
+    Generation lastComplete;
+
+    const Generation& best() const { return live.complete() ? live : lastComplete; }
+
+    static string ticketKey(const string& booking) {
+        JournalReplayer::Key key;
+        string ticket;
+        if (!JournalReplayer::describe(booking, key, ticket)) return "";
+        return to_string(key.first) + "," + key.second + "," + ticket;
     }
-    
-    cout << "\n=== Available Movies ===" << endl;
-    for (size_t i = 0; i < movies.size(); i++) {
-        cout << i+1 << ".";
-        movies[i].displayDetails();
+
+    void add(const string& booking) {
+        string key = ticketKey(booking);
+        if (key.empty() || live.tickets.count(key)) return;
+        live.tickets[key] = live.nextSeq;
+        live.bookings[live.nextSeq++] = booking;
     }
-    
-    cout << "Enter movie ID to manage seats (0 to cancel): ";
-    int movieChoice = getValidChoice(0, movies.size());
-    
-    if (movieChoice == 0) {
-        cout << "Operation cancelled." << endl;
-        return;
+
+    void remove(const string& booking) {
+        auto found = live.tickets.find(ticketKey(booking));
+        if (found == live.tickets.end()) return;
+        live.bookings.erase(found->second);
+        live.tickets.erase(found);
     }
-    
-    Movie& selectedMovie = movies[movieChoice - 1];
-    const vector<Schedule>& schedules = selectedMovie.getSchedules();
-    
-    if (schedules.empty()) {
-        cout << "No schedules available for this movie." << endl;
-        return;
+
+public:
+    uint64_t appliedBytes = 0; // primary's shipped-bytes count of the last applied batch
+    uint64_t lagMicros = 0;
+
+    // Some generation arrived whole, so the replica can take over
+    bool ready() const { return best().complete(); }
+    const string& generationID() const { return best().id; }
+    size_t bookingCount() const { return best().bookings.size(); }
+
+    void reset(const string& generation) {
+        if (live.complete()) lastComplete = std::move(live);
+        live = Generation();
+        live.id = generation;
     }
-    
-    cout << "\nAvailable dates for " << selectedMovie.getTitle() << ":" << endl;
-    for (size_t i = 0; i < schedules.size(); i++) {
-        cout << i+1 << ". " << schedules[i].getDate() << endl;
+
+    // A file arriving again after a CATALOG record replaces the earlier copy
+    // and whatever records were kept on top of it
+    void addFile(const string& name, bool last, const string& bytes) {
+        live.incoming[name] += bytes;
+        if (!last) return;
+        string content = std::move(live.incoming[name]);
+        live.incoming.erase(name);
+        if (name == "users.txt") live.userLines.clear();
+        if (name == RETIRED_FILE) live.tombstoneLines.clear();
+        live.files[name] = std::move(content);
     }
-    
-    cout << "Enter date number to manage seats (0 to cancel): ";
-    int dateChoice = getValidChoice(0, schedules.size());
-    
-    if (dateChoice == 0) {
-        cout << "Operation cancelled." << endl;
-        return;
+
+    // Applies complete "<pid>,<entry>" journal lines
+    void apply(const string& records) {
+        istringstream lines(records);
+        string line;
+        while (getline(lines, line)) {
+            size_t opStart = line.find(',') + 1;
+            if (opStart == 0) continue;
+            size_t opEnd = line.find(',', opStart);
+            string op = line.substr(opStart, opEnd == string::npos ? string::npos : opEnd - opStart);
+            string rest = opEnd == string::npos ? "" : line.substr(opEnd + 1);
+            if (op == "BASE" || op == "ADD") {
+                add(rest);
+            } else if (op == "DEL") {
+                remove(rest);
+            } else if (op == "UPD") {
+                string before, after;
+                if (!JournalReplayer::splitUpdate(rest, before, after)) continue;
+                remove(before);
+                add(after);
+            } else if (op == "USER") {
+                live.userLines.push_back(rest);
+            } else if (op == "RETIRE") {
+                live.tombstoneLines.push_back(rest);
+            } else if (op == "CHECKPOINT") {
+                live.checkpointed = true;
+            }
+        }
     }
-    
-    string selectedDate = schedules[dateChoice - 1].getDate();
-    
-    system->displaySeatLayout(selectedMovie.getMovieID(), selectedDate);
-    
-    cout << "\n1. Add new seat" << endl;
-    cout << "2. Remove seat" << endl;
-    cout << "3. Back to menu" << endl;
-    cout << "Enter choice: ";
-    int choice = getValidChoice(1, 3);
-    
-    switch (choice) {
-        case 1: {
-            string newSeat;
-            cout << "Enter new seat ID (e.g., I1): ";
-            getline(cin, newSeat);
-            transform(newSeat.begin(), newSeat.end(), newSeat.begin(), ::toupper);
-            
-            if (system->isSeatAvailable(selectedMovie.getMovieID(), selectedDate, newSeat)) {
-                system->bookSeat(selectedMovie.getMovieID(), selectedDate, newSeat);
-                system->freeSeat(selectedMovie.getMovieID(), selectedDate, newSeat);
-                system->saveData();
-                cout << "Seat added successfully." << endl;
-            } else {
-                cout << "Seat already exists." << endl;
+
+    // Writes the replica as the data files of the current directory, with
+    // fresh checksums and no journal, ready for CinemaBookingSystem to load
+    void writeDataFiles() const {
+        const Generation& replica = best();
+        DataLock::Guard guard;
+        for (const auto& file : replica.files) {
+            ostringstream out;
+            out << file.second;
+            if (file.first == RETIRED_FILE) {
+                for (const auto& tombstone : replica.tombstoneLines) out << tombstone << '\n';
+                writeWholeFile(RETIRED_FILE, out.str());
+                continue;
             }
-            break;
+            if (file.first == "users.txt") addReplicatedUsers(file.second, out);
+            IntegrityScanner::writeFile(file.first, out.str());
         }
-        case 2: {
-            string seatToRemove;
-            cout << "Enter seat ID to remove: ";
-            getline(cin, seatToRemove);
-            transform(seatToRemove.begin(), seatToRemove.end(), seatToRemove.begin(), ::toupper);
-            
-            if (!system->isSeatAvailable(selectedMovie.getMovieID(), selectedDate, seatToRemove)) {
-                cout << "Seat doesn't exist." << endl;
-            } else {
-                bool isBooked = false;
-                for (const auto& booking : system->getBookings()) {
-                    if (booking.getMovieID() == selectedMovie.getMovieID() && 
-                        booking.getSchedule().getDate() == selectedDate && 
-                        booking.getSeat() == seatToRemove) {
-                        isBooked = true;
-                        break;
+        ostringstream bookingFile;
+        for (const auto& booking : replica.bookings) bookingFile << booking.second << '\n';
+        IntegrityScanner::writeFile("bookings.txt", bookingFile.str());
+        std::remove(JOURNAL_FILE.c_str());
+    }
+
+    // Appends the users registered after the last reset to users.txt
+    void addReplicatedUsers(const string& existingUsers, ostream& out) const {
+        const Generation& replica = best();
+        set<string> usernames;
+        istringstream existing(existingUsers);
+        string line;
+        while (getline(existing, line)) {
+            size_t start = line.find(',') + 1;
+            usernames.insert(line.substr(start, line.find(',', start) - start));
+        }
+        for (const auto& user : replica.userLines) {
+            size_t start = user.find(',') + 1;
+            if (usernames.insert(user.substr(start, user.find(',', start) - start)).second) out << user << '\n';
+        }
+    }
+};
+
+static volatile sig_atomic_t promoteRequested = 0;
+
+// --standby: replicates a primary that runs with CINEMA_STANDBY set to
+// replicationPath, reporting its lag every second it receives records. When
+// the primary disconnects without a goodbye, or on SIGUSR1, the standby is
+// promoted: it writes its replica as the data files of the current directory
+// (run it from a directory of its own) and serves bookings on servePath.
+int runStandby(const string& replicationPath, const string& servePath) {
+    int listenFd = listenUnixSocket(replicationPath);
+    if (listenFd < 0) {
+        cerr << "Unable to listen on " << replicationPath << endl;
+        return 1;
+    }
+    signal(SIGUSR1, [](int) { promoteRequested = 1; });
+    signal(SIGINT, [](int) { serverStopRequested = 1; });
+    signal(SIGTERM, [](int) { serverStopRequested = 1; });
+    cout << "Standby listening on " << replicationPath << "; on promotion it serves " << servePath << endl;
+
+    StandbyReplica replica;
+    int primaryFd = -1;
+    string in;
+    bool primaryLost = false;
+    bool goodbye = false; // the primary announced a clean shutdown
+    uint64_t reportedBytes = 0;
+    while (!serverStopRequested && !primaryLost && !(promoteRequested && replica.ready())) {
+        int polledFd = primaryFd;
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {polledFd, POLLIN, 0}};
+        int ready = poll(fds, polledFd >= 0 ? 2 : 1, 1000);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                if (primaryFd >= 0) close(primaryFd);
+                primaryFd = fd;
+                in.clear();
+                goodbye = false;
+                cout << "Primary connected." << endl;
+            }
+        }
+        if (ready > 0 && polledFd >= 0 && primaryFd == polledFd && fds[1].revents) {
+            char buffer[65536];
+            ssize_t n = recv(primaryFd, buffer, sizeof(buffer), 0);
+            bool open = n > 0;
+            bool applied = false;
+            if (open) in.append(buffer, n);
+            try {
+                string frame;
+                while (open && takeFrame(in, frame)) {
+                    WireReader reader(frame, 4);
+                    uint8_t op = reader.getU8();
+                    if (op == REPL_RESET) {
+                        replica.reset(reader.getString());
+                    } else if (op == REPL_FILE) {
+                        string name = reader.getString();
+                        bool last = reader.getU8() != 0;
+                        replica.addFile(name, last, reader.getBytes());
+                    } else if (op == REPL_RECORDS) {
+                        uint64_t shipped = reader.getU64();
+                        uint64_t sentAt = reader.getU64();
+                        replica.apply(reader.getBytes());
+                        uint64_t now = wallClockMicros();
+                        replica.appliedBytes = shipped;
+                        replica.lagMicros = now > sentAt ? now - sentAt : 0;
+                        applied = true;
+                    } else if (op == REPL_BYE) {
+                        goodbye = true;
                     }
                 }
-                
-                if (isBooked) {
-                    cout << "Cannot remove seat because it has active bookings." << endl;
+            } catch (...) {
+                open = false;
+            }
+            if (open && applied) {
+                WireWriter ack;
+                ack.putU64(replica.appliedBytes);
+                ack.putU64(replica.lagMicros);
+                open = sendAll(primaryFd, ack.frame(0, REPL_ACK));
+            }
+            if (!open) {
+                close(primaryFd);
+                primaryFd = -1;
+                if (goodbye) {
+                    cout << "Primary shut down cleanly; waiting for it to come back." << endl;
                 } else {
-                    system->freeSeat(selectedMovie.getMovieID(), selectedDate, seatToRemove);
-                    system->saveData();
-                    cout << "Seat removed successfully." << endl;
+                    cout << RED << "Primary connection lost." << RESET << endl;
+                    primaryLost = replica.ready();
                 }
             }
-            break;
+        }
+        if (replica.appliedBytes != reportedBytes) {
+            reportedBytes = replica.appliedBytes;
+            cout << "Standby: generation " << replica.generationID() << ", " << replica.bookingCount()
+                 << " booking(s), " << replica.appliedBytes << " bytes applied, lag " << fixed << setprecision(1)
+                 << replica.lagMicros / 1000.0 << " ms" << endl;
         }
     }
-}
 
-void Admin::manageSchedules() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    vector<Movie>& movies = system->getMovies();
-    
-    if (movies.empty()) {
-        cout << "No movies available to manage schedules." << endl;
-        return;
-    }
-    
-    cout << "\n=== Available Movies ===" << endl;
-    for (size_t i = 0; i < movies.size(); i++) {
-        cout << i+1 << ".";
-        movies[i].displayDetails();
-    }
-    
-    cout << "Enter movie number to manage schedules (0 to cancel): ";
-    int movieChoice = getValidChoice(0, movies.size());
-    
-    if (movieChoice == 0) {
-        cout << "Operation cancelled." << endl;
-        return;
-    }
-    
-    Movie& selectedMovie = movies[movieChoice - 1];
-    
-    cout << "\nCurrent schedules for " << selectedMovie.getTitle() << ":" << endl;
-    const vector<Schedule>& schedules = selectedMovie.getSchedules();
-    for (size_t i = 0; i < schedules.size(); i++) {
-        cout << i+1 << ". ";
-        schedules[i].display();
-        cout << endl;
+    if (primaryFd >= 0) close(primaryFd);
+    close(listenFd);
+    unlink(replicationPath.c_str());
+    if (serverStopRequested || !replica.ready()) {
+        if (!replica.ready()) cout << "Standby stopped before receiving a complete replica." << endl;
+        return 0;
     }
-    
-    cout << "\n1. Add schedule" << endl;
-    cout << "2. Remove schedule" << endl;
-    cout << "3. Back to menu" << endl;
-    cout << "Enter choice: ";
-    int choice = getValidChoice(1, 3);
-    
-    switch (choice) {
-        case 1: {
-            cout << "\nAdding new schedule:" << endl;
-            Schedule newSchedule = system->getValidSchedule();
-            selectedMovie.addSchedule(newSchedule);
-            system->initializeSeatsForNewMovie(selectedMovie.getMovieID(), newSchedule.getDate());
-            system->saveData();
-            cout << "Schedule added successfully." << endl;
-            break;
+
+    cout << YELLOW << "Promoting standby (generation " << replica.generationID() << ", " << replica.bookingCount()
+         << " booking(s))." << RESET << endl;
+    replica.writeDataFiles();
+    int repaired = CinemaBookingSystem::getInstance()->rebuildSeatsFromBookings();
+    if (repaired > 0) cout << "Re-derived " << repaired << " showtime seat map(s) from the replicated bookings." << endl;
+    return serveBookings(servePath);
+}
+#endif
+
+// --bench-recovery: times JournalReplayer on synthetic journals of growing
+// length (a checkpoint plus random ADD/DEL/UPD records over 1000 showtimes)
+// with 1, 2, 4... threads. No data files are touched.
+int runRecoveryBenchmark(size_t maxRecords, size_t maxThreads) {
+    uint64_t state = 88172645463325252ULL;
+    auto nextRandom = [&](uint64_t bound) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state % bound;
+    };
+    auto randomBooking = [&](size_t id) {
+        ostringstream line;
+        line << id << ",user" << nextRandom(5000) << "," << nextRandom(50) + 1 << ",2030-01-" << setw(2) << setfill('0')
+             << nextRandom(20) + 1 << ",18:00," << static_cast<char>('A' + nextRandom(8)) << nextRandom(10) + 1
+             << ",390.00,Cash";
+        return line.str();
+    };
+
+    cout << "  Records    Threads   Seconds    Records/s    Live bookings" << endl;
+    for (size_t length = max<size_t>(1000, maxRecords / 100); length <= maxRecords; length *= 10) {
+        string journal = "#JOURNAL,bench\n";
+        vector<string> live;
+        for (size_t i = 0; i < length / 10; i++) {
+            live.push_back(randomBooking(i));
+            journal += "1,BASE," + live.back() + "\n";
         }
-        case 2:
-            if (!schedules.empty()) {
-                cout << "Enter schedule number to remove: ";
-                int removeIndex = getValidChoice(1, schedules.size());
-                
-                if (system->hasBookingsForSchedule(selectedMovie.getMovieID(), schedules[removeIndex - 1].getDate())) {
-                    cout << "Cannot remove schedule because there are existing bookings." << endl;
-                } else {
-                    system->removeSeatsForMovie(selectedMovie.getMovieID(), schedules[removeIndex - 1].getDate());
-                    selectedMovie.removeSchedule(removeIndex - 1);
-                    system->saveData();
-                    cout << "Schedule removed successfully." << endl;
-                }
+        journal += "1,CHECKPOINT," + to_string(live.size()) + "\n";
+        for (size_t i = live.size(); i < length; i++) {
+            uint64_t kind = nextRandom(100);
+            if (kind < 60 || live.empty()) {
+                live.push_back(randomBooking(i));
+                journal += "1,ADD," + live.back() + "\n";
+                continue;
+            }
+            size_t victim = nextRandom(live.size());
+            if (kind < 85) {
+                journal += "1,DEL," + live[victim] + "\n";
+                live[victim] = live.back();
+                live.pop_back();
             } else {
-                cout << "No schedules to remove." << endl;
+                string moved = randomBooking(i);
+                journal += "1,UPD," + live[victim] + "," + moved + "\n";
+                live[victim] = moved;
             }
-            break;
+        }
+
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            auto started = chrono::steady_clock::now();
+            JournalReplayer::Result result = JournalReplayer::replay(journal, threads);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+            size_t survivors = 0;
+            for (const auto& partition : result.live) survivors += partition.second.size();
+            cout << "  " << left << setw(11) << length << setw(10) << threads << fixed << setprecision(3) << setw(10)
+                 << seconds << setprecision(0) << setw(13) << (seconds > 0 ? result.records / seconds : 0.0)
+                 << survivors << endl;
+        }
     }
+    return 0;
 }
 
-void Admin::generateReports() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    const vector<Booking>& bookings = system->getBookings();
-    const vector<Movie>& movies = system->getMovies();
-    
-    if (bookings.empty()) {
-        cout << "\n\t╔═══════════════════════════════════╗" << endl;
-        cout << YELLOW << "\t║      No bookings to generate      ║" << RESET << endl;
-        cout << YELLOW << "\t║           reports.                ║" << RESET << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
-        return;
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+    string socketPath = argc > 2 ? argv[2] : DEFAULT_SOCKET;
+    if (mode == "--bench-recovery") {
+        return runRecoveryBenchmark(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000,
+                                    argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency()));
     }
-    
-    map<int, pair<int, double>> movieStats;
-    double totalRevenue = 0.0;
-    
-    for (const auto& booking : bookings) {
-        movieStats[booking.getMovieID()].first++;
-        movieStats[booking.getMovieID()].second += booking.getPrice();
-        totalRevenue += booking.getPrice();
+    if (mode == "--replay") {
+#ifdef __cpp_impl_coroutine
+        return runReplay(argc > 2 ? argv[2] : "", argc > 3 ? atoi(argv[3]) : 1, argc > 4 ? atoi(argv[4]) : 1);
+#else
+        cerr << "--replay needs a C++20 build (-std=c++20)." << endl;
+        return 1;
+#endif
     }
-    
-    cout << "\n\t╔═══════════════════════════════════════════════════╗" << endl;
-    cout << CYAN << "\t║                   Sales Report                    ║" << RESET << endl;
-    cout << "\t╠═══════════════════════╦═══════════╦═══════════════╣" << endl;
-    cout << "\t║      Movie Title      ║  Tickets  ║    Revenue    ║" << endl;
-    cout << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
-    
-    for (const auto& movie : movies) {
-        auto it = movieStats.find(movie.getMovieID());
-        if (it != movieStats.end()) {
-            cout << "\t║ " << YELLOW << left << setw(22) << movie.getTitle().substr(0, 19) << RESET
-                 << "║ " << CYAN << right << setw(9) << it->second.first << RESET
-                 << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << it->second.second << RESET << " ║" << endl;
-        }
+    if (mode == "--standby") {
+#ifdef __linux__
+        return runStandby(argc > 2 ? argv[2] : "standby.sock", argc > 3 ? argv[3] : DEFAULT_SOCKET);
+#else
+        cerr << mode << " is only available on Linux." << endl;
+        return 1;
+#endif
     }
-    
-    cout << "\t╠═══════════════════════╬═══════════╬═══════════════╣" << endl;
-    cout << "\t║ " << CYAN << "TOTAL" << RESET << "                 ║ " 
-         << CYAN << right << setw(9) << bookings.size() << RESET
-         << " ║ ₱" << GREEN << right << setw(12) << fixed << setprecision(2) << totalRevenue << RESET << " ║" << endl;
-    cout << "\t╚═══════════════════════╩═══════════╩═══════════════╝" << endl;
-}
-
-void Admin::displayMenu() {
-    CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
-    bool logout = false;
-    
-    while (!logout) {
-        cout << "\n\n\t╔═══════════════════════════════════╗" << endl;
-        cout << "\t║           Admin Menu              ║" << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << "\t║  1. Add Movie                     ║" << endl;
-        cout << "\t║  2. Edit Movie                    ║" << endl;
-        cout << "\t║  3. Delete Movie                  ║" << endl;
-        cout << "\t║  4. View All Bookings             ║" << endl;
-        cout << "\t║  5. Manage Seats                  ║" << endl;
-        cout << "\t║  6. Manage Schedules              ║" << endl;
-        cout << "\t║  7. Generate Reports              ║" << endl;
-        cout << "\t║  8. Logout                        ║" << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
-        
-        int choice = getValidChoice(1, 8);
-
-        switch (choice) {
-            case 1:
-                addMovie();
-                break;
-            case 2:
-                editMovie();
-                break;
-            case 3:
-                deleteMovie();
-                break;
-            case 4:
-                viewAllBookings();
-                break;
-            case 5:
-                manageSeats();
-                break;
-            case 6:
-                manageSchedules();
-                break;
-            case 7:
-                generateReports();
-                break;
-            case 8:
-                cout << "\n\t╔═══════════════════════════════════╗" << endl;
-                cout << YELLOW << "\t║          Logging out...           ║" << RESET << endl;
-                cout << "\t╚═══════════════════════════════════╝" << endl;
-                cout << "\n";
-                logout = true;
-                break;
+    if (mode == "--server" || mode == "--loadgen") {
+#ifdef __linux__
+        if (mode == "--loadgen") {
+            return runLoadGenerator(socketPath, argc > 3 ? atoi(argv[3]) : 4, argc > 4 ? atoi(argv[4]) : 100000,
+                                    argc > 5 ? atoi(argv[5]) : 32);
         }
+        return serveBookings(socketPath);
+#else
+        cerr << mode << " is only available on Linux." << endl;
+        return 1;
+#endif
     }
-}
 
-int main() {
     // Initialize system
     CinemaBookingSystem* system = CinemaBookingSystem::getInstance();
+    if (mode == "--client" && !system->connectToServer(socketPath)) {
+        cerr << "Unable to reach the booking server at " << socketPath << endl;
+        CinemaBookingSystem::cleanup();
+        return 1;
+    }
     
     // Add default admin if none exists
     bool hasAdmin = false;
@@ -1593,32 +8246,11 @@ int main() {
         system->saveData();
     }
 
-    // Main menu loop
-    bool exitProgram = false;
-    while (!exitProgram) {
-        cout << "\n\t╔═══════════════════════════════════╗" << endl;
-        cout << "\t║      Cinema Booking System        ║" << endl;
-        cout << "\t╠═══════════════════════════════════╣" << endl;
-        cout << "\t║  1. Login                         ║" << endl;
-        cout << "\t║  2. Register                      ║" << endl;
-        cout << "\t║  3. Exit                          ║" << endl;
-        cout << "\t╚═══════════════════════════════════╝" << endl;
-        
-        switch (getValidChoice(1, 3)) {
-            case 1: {
-                if (User* user = system->login()) {
-                    user->displayMenu();
-                }
-                break;
-            }
-            case 2:
-                system->registerUser();
-                break;
-            case 3:
-                exitProgram = getConfirmation("Are you sure you want to exit?");
-                break;
-        }
-    }
+#ifdef __cpp_impl_coroutine
+    runConsole();
+#else
+    cerr << "The menus need a C++20 build (-std=c++20)." << endl;
+#endif
 
     CinemaBookingSystem::cleanup();
     return 0;